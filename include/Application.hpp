@@ -5,16 +5,24 @@
 
 #pragma once
 
+#include <functional>
 #include <iostream>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 #include <glm/vec2.hpp>
 
 #include "Camera.hpp"
+#include "FileWatcher.hpp"
+#include "FrameData.hpp"
+#include "RingBuffer.hpp"
 #include "Shader.hpp"
 #include "Texture.hpp"
 #include "Window.hpp"
+#include "quality.hpp"
 #include "mesh/Mesh.hpp"
+#include "terrain/TerrainCapture.hpp"
+#include "terrain/Vegetation.hpp"
 
 using namespace glm;
 
@@ -84,39 +92,53 @@ private:
     void updateVariables();
 
     /**
-     * @brief Configures the ImGui window to show debug information.
+     * @brief Reloads the shader programs whose files changed, advances the builds of the shader
+     * programs and sets the constant uniforms of the ones that just became ready or were replaced.
      */
-    void debugWindow();
+    void updateShaders();
 
     /**
-     * @brief Updates all of the terrain's shader program's uniforms.
+     * @brief Uploads the textures whose images were decoded.
      */
-    void updateTerrainUniforms();
+    void updateTextures();
 
     /**
-     * @brief Draws the water.
+     * @brief Changes the quality tier of the shader programs, which are reloaded in the background.
+     * @param tier The new quality tier.
      */
-    void drawWater();
+    void setQuality(Quality::Tier tier);
 
     /**
-     * @brief Updates all of the water's shader program's uniforms.
+     * @brief Writes the values shared by every shader program in the dynamic buffer and binds them
+     * to the FrameData uniform block.
      */
-    void updateWaterUniforms();
+    void updateFrameData();
 
     /**
-     * @brief Updates all of the noise water's shader program's uniforms.
+     * @brief Configures the ImGui window to show debug information.
      */
-    void updateNoiseWaterUniforms();
+    void debugWindow();
 
     /**
-     * @brief Draws the clouds.
+     * @brief Culls the chunks around the camera and draws the visible ones.
      */
-    void drawClouds();
+    void drawTerrain();
+
+    /**
+     * @brief Captures the tessellated chunks around the camera with transform feedback. The
+     * results are read back during a later frame.
+     */
+    void captureTerrain();
 
     /**
-     * @brief Updates all of the clouds's shader program's uniforms.
+     * @brief Draws the water.
      */
-    void updateCloudsUniforms();
+    void drawWater();
+
+    /**
+     * @brief Draws the clouds.
+     */
+    void drawClouds();
 
     /**** Variables & Constants ****/
     Window window; ///< The GLFW window.
@@ -134,10 +156,21 @@ private:
     bool cullface;        ///< Whether face culling is activated.
     bool isCursorVisible; ///< Whether the cursor is currently visible.
 
+    float firstFrameTime;    ///< The time the first frame was presented at in milliseconds.
+    float shadersReadyTime;  ///< The time every shader program was ready at in milliseconds.
+    float texturesReadyTime; ///< The time every texture was uploaded at in milliseconds.
+
     Shader* sTerrain; ///< The shader program for rendering the terrain.
+    Shader* sTerrainCapture; ///< The shader program capturing the tessellated terrain.
     Shader* sWater;   ///< The shader program for rendering the water.
     Shader* sNWater;  ///< The shader program for rendering the water made with noise.
     Shader* sClouds;  ///< The shader program for rendering the clouds.
+    Shader* sVegetation; ///< The shader program for rendering the grass and rocks.
+
+    /// Every shader program, with what to set once it is built or reloaded.
+    std::vector<std::pair<Shader*, std::function<void(Shader&)>>> shaders;
+    FileWatcher shaderWatcher; ///< Watches the shaders' files to reload the programs using them.
+    Quality::Tier quality;     ///< The quality tier of the terrain, water and clouds programs.
 
     const float chunkSize; ///< The side length of a chunk.
     const int chunks;      ///< The side length of the chunk grid.
@@ -149,10 +182,18 @@ private:
     const vec3& cameraPos; ///< The camera's position.
     vec2 cameraChunk;      ///< The chunk the camera is in.
 
-    Mesh grid;   ///< Mesh for a grid. Used to render the terrain.
+    Mesh chunk;  ///< Mesh for a chunk. Instanced for each visible chunk to render the terrain.
     Mesh screen; ///< Mesh for a screen. Used to render the clouds.
     Mesh plane;  ///< Mesh for a plane. Used to render the water.
 
+    RingBuffer dynamicData;           ///< Per-frame data, such as the centers of the visible chunks.
+    int uniformAlignment;             ///< The alignment of uniform blocks in a buffer.
+    TerrainCapture terrainCapture;    ///< Captures the tessellated terrain around the camera.
+    bool captureRequested;            ///< Whether the terrain should be captured this frame.
+    std::vector<float> visibleChunks; ///< The centers of the chunks that passed culling this frame.
+
+    Vegetation vegetation; ///< The grass and rocks scattered on the terrain.
+
     Texture texRock;       ///< Tileable rocky texture.
     Texture texRockSmooth; ///< Smoother tileable rocky texture.
     Texture texGrass;      ///< Tileable grass texture.
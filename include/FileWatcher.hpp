@@ -0,0 +1,49 @@
+/***************************************************************************************************
+ * @file  FileWatcher.hpp
+ * @brief Declaration of the FileWatcher class
+ **************************************************************************************************/
+
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @class FileWatcher
+ * @brief Watches the files of a directory tree with inotify, to reload them when they are saved.
+ * Watching is disabled if inotify isn't available. Cannot be copied.
+ */
+class FileWatcher {
+public:
+    /**
+     * @brief Starts watching a directory and its subdirectories.
+     * @param directory The path to the directory.
+     */
+    FileWatcher(const std::string& directory);
+
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator= (const FileWatcher&) = delete;
+
+    /**
+     * @brief Stops watching the directory.
+     */
+    ~FileWatcher();
+
+    /**
+     * @brief Returns the files that were written or moved in the tree since the last call. New
+     * subdirectories start being watched. Never waits.
+     * @return The normalized paths of the changed files, each appearing once.
+     */
+    std::vector<std::string> poll();
+
+private:
+    /**
+     * @brief Watches a directory and its subdirectories.
+     * @param directory The path to the directory.
+     */
+    void watch(const std::string& directory);
+
+    int descriptor; ///< The inotify instance, -1 if watching is disabled.
+    std::unordered_map<int, std::string> directories; ///< The watched directories by watch descriptor.
+};
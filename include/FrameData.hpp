@@ -0,0 +1,40 @@
+/***************************************************************************************************
+ * @file  FrameData.hpp
+ * @brief Declaration of the FrameData struct
+ **************************************************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <glm/mat4x4.hpp>
+
+using namespace glm;
+
+/**
+ * @struct FrameData
+ * @brief Values shared by every shader program and written once per frame in a uniform buffer.
+ * Mirrors the std140 FrameData block of shaders/common/frame_data.glsl, any change must be
+ * reflected there.
+ */
+struct FrameData {
+    static constexpr unsigned int BINDING = 0; ///< The uniform buffer binding point of the block.
+
+    mat4 vpMatrix;                    ///< The view/projection matrix.
+    vec3 cameraPos;                   ///< The position of the camera.
+    float time;                       ///< The time since the start in seconds.
+    alignas(16) vec3 cameraFront;     ///< The direction of the camera.
+    alignas(16) vec3 cameraRight;     ///< The right vector of the camera.
+    alignas(16) vec3 cameraUp;        ///< The up vector of the camera.
+    alignas(16) vec3 lightDirection;  ///< The direction of the sun light.
+    alignas(16) vec2 resolution;      ///< The resolution of the window.
+};
+
+static_assert(offsetof(FrameData, cameraPos) == 64);
+static_assert(offsetof(FrameData, time) == 76);
+static_assert(offsetof(FrameData, cameraFront) == 80);
+static_assert(offsetof(FrameData, cameraRight) == 96);
+static_assert(offsetof(FrameData, cameraUp) == 112);
+static_assert(offsetof(FrameData, lightDirection) == 128);
+static_assert(offsetof(FrameData, resolution) == 144);
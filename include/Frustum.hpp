@@ -0,0 +1,46 @@
+/***************************************************************************************************
+ * @file  Frustum.hpp
+ * @brief Declaration of the Frustum class
+ **************************************************************************************************/
+
+#pragma once
+
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <glm/mat4x4.hpp>
+
+using namespace glm;
+
+/**
+ * @class Frustum
+ * @brief The 6 planes of a camera's view frustum, used to cull bounding boxes on the CPU.
+ */
+class Frustum {
+public:
+    /**
+     * @brief Extracts the planes from a view/projection matrix.
+     * @param vpMatrix The view/projection matrix.
+     */
+    Frustum(const mat4& vpMatrix);
+
+    /**
+     * @brief Checks whether an axis aligned bounding box is at least partially inside the frustum.
+     * Boxes close to the corners of the frustum can be falsely reported as visible.
+     * @param low The corner of the box with the lowest coordinates.
+     * @param high The corner of the box with the highest coordinates.
+     * @return Whether the box may be visible.
+     */
+    bool intersects(const vec3& low, const vec3& high) const;
+
+    /**
+     * @brief Checks whether a sphere is at least partially inside the frustum. Spheres close to
+     * the corners of the frustum can be falsely reported as visible.
+     * @param center The center of the sphere.
+     * @param radius The radius of the sphere.
+     * @return Whether the sphere may be visible.
+     */
+    bool intersects(const vec3& center, float radius) const;
+
+private:
+    vec4 planes[6]; ///< The planes, with their normals pointing inside the frustum.
+};
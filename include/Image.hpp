@@ -20,6 +20,16 @@ public:
      */
     Image(const std::string& path);
 
+    /**
+     * @brief Decodes an image from the content of its file.
+     * @param buffer The content of the image file.
+     * @param size The size of the content in bytes.
+     */
+    Image(const unsigned char* buffer, unsigned int size);
+
+    Image(const Image&) = delete;
+    Image& operator= (const Image&) = delete;
+
     /**
      * @brief Frees all the allocated memory.
      */
@@ -0,0 +1,109 @@
+/***************************************************************************************************
+ * @file  MipChain.hpp
+ * @brief Declaration of the MipChain class
+ **************************************************************************************************/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Image.hpp"
+
+/**
+ * @class MipChain
+ * @brief Every level of a RGB texture, from its full size down to 1*1px, ready to be uploaded. The
+ * levels are downsampled from an image with a gamma correct box filter, then stored in
+ * cache/textures/ so that the next startups memory map them instead of decoding the image. A file
+ * starts with a header, followed by the table of the levels, then by the level blobs aligned on 16
+ * bytes. Cannot be copied.
+ */
+class MipChain {
+public:
+    /**
+     * @struct Level
+     * @brief A level of the texture, with tightly packed RGB rows.
+     */
+    struct Level {
+        unsigned int width;        ///< The width of the level.
+        unsigned int height;       ///< The height of the level.
+        const unsigned char* data; ///< The texels of the level.
+    };
+
+    /**
+     * @brief Loads the levels of an image file from the cache, or decodes the image, downsamples it
+     * and stores its levels in the cache if they are missing or older than the file. Can be called
+     * from any thread.
+     * @param path The path to the image file.
+     * @return The levels of the image.
+     * @throws std::runtime_error If the image file can't be read or decoded.
+     */
+    static std::unique_ptr<MipChain> get(const std::string& path);
+
+    /**
+     * @brief Downsamples an image down to 1*1px, averaging the texels in linear space.
+     * @param image The image, with 3 channels.
+     */
+    MipChain(const Image& image);
+
+    MipChain(const MipChain&) = delete;
+    MipChain& operator= (const MipChain&) = delete;
+
+    /**
+     * @brief Unmaps the file the levels were loaded from, if any.
+     */
+    ~MipChain();
+
+    /**
+     * @brief Stores the levels in a file.
+     * @param path The path of the file.
+     * @param sourceSize The size of the image file the levels come from.
+     * @param sourceTime The last modification time of the image file the levels come from.
+     * @throws std::runtime_error If the file can't be written.
+     */
+    void save(const std::string& path, uint64_t sourceSize, int64_t sourceTime) const;
+
+    /**
+     * @brief Memory maps the levels stored in a file.
+     * @param path The path of the file.
+     * @param sourceSize The size of the image file the levels must come from.
+     * @param sourceTime The last modification time of the image file the levels must come from.
+     * @return The levels, or null if the file is missing, invalid, of another version or outdated.
+     */
+    static std::unique_ptr<MipChain> load(const std::string& path, uint64_t sourceSize, int64_t sourceTime);
+
+    /**
+     * @brief Getter for the levels member.
+     * @return The levels, from the largest to the 1*1px one.
+     */
+    const std::vector<Level>& getLevels() const;
+
+    /**
+     * @brief Getter for the hits member.
+     * @return The amount of mip chains loaded from the cache.
+     */
+    static unsigned int getHits();
+
+    /**
+     * @brief Getter for the misses member.
+     * @return The amount of mip chains that had to be generated.
+     */
+    static unsigned int getMisses();
+
+private:
+    /**
+     * @brief Creates an empty mip chain, to be filled by load.
+     */
+    MipChain();
+
+    static std::atomic<unsigned int> hits;   ///< The amount of mip chains loaded from the cache.
+    static std::atomic<unsigned int> misses; ///< The amount of mip chains that had to be generated.
+
+    std::vector<Level> levels;          ///< The levels, pointing in storage or in the mapping.
+    std::vector<unsigned char> storage; ///< The texels of generated levels.
+    void* mapping;                      ///< The mapped file of loaded levels, null if generated.
+    size_t mappingSize;                 ///< The size of the mapped file.
+};
@@ -0,0 +1,107 @@
+/***************************************************************************************************
+ * @file  RingBuffer.hpp
+ * @brief Declaration of the RingBuffer class
+ **************************************************************************************************/
+
+#pragma once
+
+#include <span>
+#include <vector>
+
+#include "mesh/handles.hpp"
+
+/**
+ * @class RingBuffer
+ * @brief A buffer for data that changes every frame, such as culled instances or indices. It is
+ * split in one region per frame in flight and each frame writes in the next region, after waiting
+ * for the GPU to be done with the frame that last used it. When supported, the buffer is created
+ * with glBufferStorage and stays mapped, so writing to it is a plain copy. Cannot be copied.
+ */
+class RingBuffer {
+public:
+    /**
+     * @brief Creates the buffer and maps it if possible.
+     * @param frameSize The amount of bytes that can be written during one frame.
+     * @param frames The amount of frames that can be in flight at once.
+     */
+    RingBuffer(unsigned int frameSize, unsigned int frames = 3);
+
+    RingBuffer(const RingBuffer&) = delete;
+    RingBuffer& operator= (const RingBuffer&) = delete;
+
+    /**
+     * @brief Deletes the fences of the frames still in flight. The buffer is unmapped when
+     * deleted.
+     */
+    ~RingBuffer();
+
+    /**
+     * @brief Moves to the next region, waiting for the GPU to finish the frame that used it.
+     */
+    void beginFrame();
+
+    /**
+     * @brief Places a fence after the commands of the frame, which must not write anymore.
+     */
+    void endFrame();
+
+    /**
+     * @brief Copies data in the region of the current frame.
+     * @param data The data.
+     * @param size The size of the data in bytes.
+     * @param alignment The alignment of the data in the buffer in bytes, e.g.
+     * GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT for uniform blocks.
+     * @return The offset of the data in the buffer.
+     * @throws std::runtime_error If the region of the frame is full.
+     */
+    unsigned int write(const void* data, unsigned int size, unsigned int alignment = 16);
+
+    /**
+     * @brief Copies values in the region of the current frame.
+     * @param values The values.
+     * @param alignment The alignment of the values in the buffer in bytes.
+     * @return The offset of the first value in the buffer.
+     * @throws std::runtime_error If the region of the frame is full.
+     */
+    template<typename T>
+    unsigned int write(std::span<const T> values, unsigned int alignment = 16) {
+        return write(values.data(), values.size_bytes(), alignment);
+    }
+
+    /**
+     * @brief Returns the id of the buffer, to source attributes, indices or uniform blocks from it.
+     * @return The buffer's id.
+     */
+    unsigned int getBuffer() const;
+
+    /**
+     * @brief Checks whether the buffer is persistently mapped. If not, writes go through
+     * glBufferSubData.
+     * @return Whether the buffer is persistently mapped.
+     */
+    bool isPersistent() const;
+
+    /**
+     * @brief Getter for the occupancy member.
+     * @return The ratio of the region used by the last finished frame.
+     */
+    float getOccupancy() const;
+
+    /**
+     * @brief Getter for the stallTime member.
+     * @return The time spent waiting for the GPU in the last call to beginFrame in milliseconds.
+     */
+    float getStallTime() const;
+
+private:
+    Buffer buffer;                ///< The buffer, holding one region per frame.
+    unsigned char* mapping;       ///< The persistently mapped buffer, null if not supported.
+    const unsigned int frameSize; ///< The size of a region in bytes.
+    std::vector<void*> fences;    ///< The fence of the last frame that used each region. Can be null.
+
+    unsigned int frame; ///< The index of the region of the current frame.
+    unsigned int head;  ///< The amount of bytes used in the region of the current frame.
+
+    float occupancy; ///< The ratio of the region used by the last finished frame.
+    float stallTime; ///< The time spent waiting for the GPU in the last frame in milliseconds.
+};
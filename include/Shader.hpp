@@ -5,9 +5,17 @@
 
 #pragma once
 
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <future>
 #include <iostream>
+#include <memory>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
 
 #include "glm/vec2.hpp"
 #include "glm/vec3.hpp"
@@ -16,21 +24,45 @@
 
 using namespace glm;
 
+template<typename T>
+class UniformHandle;
+
 /**
  * @class Shader
  * @brief Compiles, links and creates a shader program that can be then be bound. Can set the value
- * of uniforms in the shader program.
+ * of uniforms in the shader program. Linked programs are stored as driver binaries in
+ * cache/shaders/ and loaded from there on the next startups, unless a source or the driver changed.
+ * A program can also be built asynchronously: its files are read on a worker thread, all its stages
+ * are submitted at once and its completion is polled, so that frames can be drawn meanwhile.
+ * Sources are preprocessed: '#include "path"' lines are replaced by the included files and macros
+ * are defined after the #version directive, so that each set of definitions is a separate variant
+ * with its own cached binary. #line directives keep the lines of the compile errors those of the
+ * files, which are numbered in the error message. A program can be reloaded while in use: the new one is built in the
+ * background and replaces it only if it compiles and links. The last value of each uniform is kept,
+ * so that setting a uniform to the value it already has and using the program in use do nothing.
  */
 class Shader {
 public:
+    /**
+     * @brief The macros defined in each shader of a program, as names and values.
+     */
+    using Defines = std::vector<std::pair<std::string, std::string>>;
 
     /**
-     * @brief Creates a shader program and compiles then attaches the shaders at the specified paths
-     * to it.
+     * @brief Creates a shader program from its cached binary, or compiles then attaches the shaders
+     * at the specified paths to it.
      * @param paths The paths to each of the different shaders.
      * @param count The amount of shaders to attach.
+     * @param name The name of the shader program, used in error messages.
+     * @param varyings The outputs captured with transform feedback, interleaved in a single buffer.
+     * @param defines The macros defined in each shader, e.g. quality settings.
+     * @param async Whether to return before the program is built, poll must then be called until
+     * it is ready. Otherwise the program is ready once constructed.
+     * @throws std::runtime_error If a file can't be read, a shader fails to compile or the program
+     * fails to link. Thrown by poll instead when building asynchronously.
      */
-    Shader(const std::string* paths, unsigned int count, const std::string& name);
+    Shader(const std::string* paths, unsigned int count, const std::string& name,
+           const std::vector<std::string>& varyings = {}, const Defines& defines = {}, bool async = false);
 
     /**
      * @brief Deletes the shader program.
@@ -38,17 +70,117 @@ public:
     ~Shader();
 
     /**
-     * @brief Compiles a shader and returns its corresponding id.
-     * @param path The path to the shader file.
+     * @brief Advances the asynchronous build of the shader program, or of its reloaded version,
+     * without waiting for the worker thread or the driver. A reloaded version that fails to build
+     * is dropped and its errors are printed.
+     * @return Whether the program became ready or was replaced by its reloaded version, in which
+     * case the uniforms that aren't in uniform blocks must be set again.
+     * @throws std::runtime_error If a file can't be read, a shader fails to compile or the program
+     * fails to link during the first build.
+     */
+    bool poll();
+
+    /**
+     * @brief Checks whether the shader program is built, without advancing its build.
+     * @return Whether the shader program is ready to be used.
+     */
+    bool isReady() const;
+
+    /**
+     * @brief Starts building the program again from its files in the background. The current
+     * program stays in use until poll replaces it. Restarts a reload that is still pending.
+     */
+    void reload();
+
+    /**
+     * @brief Replaces the macros defined in each shader and reloads the program with them.
+     * @param defines The macros defined in each shader.
+     */
+    void setDefines(const Defines& defines);
+
+    /**
+     * @brief Checks whether the shader program is built from a file, including the included ones.
+     * @param path The normalized path to the file.
+     * @return Whether the program must be reloaded when the file changes.
+     */
+    bool dependsOn(const std::string& path) const;
+
+    /**
+     * @brief Submits the compilation of a shader and returns its corresponding id. Whether it
+     * compiled is only checked once the program is linked.
+     * @param path The path to the shader file, which tells the type of the shader.
+     * @param source The source code of the shader.
      * @return The shader's corresponding id.
      */
-    unsigned int compileShader(const std::string& path);
+    unsigned int compileShader(const std::string& path, const std::string& source);
 
     /**
-     * @brief Uses the shader program.
+     * @brief Uses the shader program, unless it is already in use.
      */
     void use();
 
+    /**
+     * @brief Returns the shader program that is currently in use.
+     * @return The shader program that was used last, nullptr if none was.
+     */
+    static Shader* getBound();
+
+    /**
+     * @brief Getter for the programCount member.
+     * @return The amount of shader programs created so far, including reloaded ones.
+     */
+    static unsigned int getProgramCount();
+
+    /**
+     * @brief Getter for the cachedProgramCount member.
+     * @return The amount of shader programs loaded from the program binary cache.
+     */
+    static unsigned int getCachedProgramCount();
+
+    /**
+     * @brief Getter for the loadTime member.
+     * @return The time the main thread spent creating all the shader programs in milliseconds.
+     */
+    static float getLoadTime();
+
+    /**
+     * @brief Getter for the reloadTime member.
+     * @return The time between the last reload request and the replacement of the program in
+     * milliseconds.
+     */
+    static float getReloadTime();
+
+    /**
+     * @brief Getter for the uploadCount member.
+     * @return The amount of uniform values sent to the driver since the last reset.
+     */
+    static unsigned int getUploadCount();
+
+    /**
+     * @brief Getter for the skippedUploadCount member.
+     * @return The amount of uniform values that weren't sent because they didn't change since the
+     * last reset.
+     */
+    static unsigned int getSkippedUploadCount();
+
+    /**
+     * @brief Getter for the skippedUseCount member.
+     * @return The amount of times a program wasn't used because it already was since the last reset.
+     */
+    static unsigned int getSkippedUseCount();
+
+    /**
+     * @brief Resets the upload and use counts, e.g. at the start of a frame.
+     */
+    static void resetCounts();
+
+    /**
+     * @brief Sets the value of the 'attributes' uniform that tells which vertex attributes a mesh
+     * has. Nothing is uploaded if the shader program doesn't use it or if the value didn't change.
+     * @param attributes The attributes' bit masks.
+     */
+    void setAttributes(unsigned int attributes);
+
     /**
      * @brief Finds and adds all the shader's uniforms' id's to the map.
      */
@@ -61,19 +193,195 @@ public:
      */
     template<typename... Value>
     void setUniform(const std::string& uniform, Value... value) {
-        try {
-            setUniform(uniforms.at(uniform), value...);
-        } catch(const std::exception&) {
-            if(!unknownUniforms.contains(uniform)) {
-                std::cout << "The uniform named '" << uniform << "' is unknown or unused";
-                std::cout << " in shader program '" << name << "'.\n";
-
-                unknownUniforms.emplace(uniform, true);
+        const auto location = uniforms.find(uniform);
+        if(location != uniforms.end()) {
+            if(values[location->second].update(value...)) {
+                setUniform(location->second, value...);
             }
+        } else {
+            warnUnknownUniform(uniform);
+        }
+    }
+
+    /**
+     * @brief Resolves the location of a uniform once, so that its value can then be set without
+     * looking it up by name.
+     * @tparam T The type of the uniform: int, unsigned int, bool, float, vec2, vec3, vec4 or mat4.
+     * @param uniform The uniform's name.
+     * @return The handle to the uniform, which does nothing if the uniform is unknown or unused.
+     * It stays valid when the program is reloaded. The shader program must outlive it.
+     */
+    template<typename T>
+    UniformHandle<T> getUniformHandle(const std::string& uniform) {
+        if(!uniforms.contains(uniform)) {
+            warnUnknownUniform(uniform);
         }
+
+        return UniformHandle<T>(this, uniform);
     }
 
 private:
+    template<typename T>
+    friend class UniformHandle;
+
+    /**
+     * @enum State
+     * @brief The steps of the build of a shader program.
+     */
+    enum State {
+        READING, ///< The source files are being read.
+        LINKING, ///< The program is loaded from its binary or being compiled and linked.
+        READY    ///< The program can be used.
+    };
+
+    /**
+     * @struct UniformValue
+     * @brief The last value sent to the driver for a uniform.
+     */
+    struct UniformValue {
+        std::array<unsigned char, sizeof(mat4)> bytes; ///< The bytes of the value.
+        bool known = false;                            ///< Whether a value was sent.
+
+        /**
+         * @brief Replaces the value if it changed, counting the skipped uploads otherwise.
+         * @param value The new value, or its components.
+         * @return Whether the value changed and must be sent to the driver.
+         */
+        template<typename... Value>
+        bool update(const Value&... value) {
+            static_assert((sizeof(Value) + ...) <= sizeof(mat4));
+
+            std::array<unsigned char, sizeof(mat4)> candidate{};
+            size_t offset = 0;
+            ((std::memcpy(candidate.data() + offset, &value, sizeof(Value)), offset += sizeof(Value)), ...);
+
+            if(known && candidate == bytes) {
+                ++skippedUploadCount;
+                return false;
+            }
+
+            bytes = candidate;
+            known = true;
+            ++uploadCount;
+
+            return true;
+        }
+    };
+
+    /**
+     * @struct Sources
+     * @brief The preprocessed shaders of a program and the files they were read from.
+     */
+    struct Sources {
+        std::vector<std::string> code;                     ///< The source code of each of the shaders.
+        std::unordered_set<std::string> files;             ///< The normalized paths of the files read.
+        std::vector<std::vector<std::string>> sourceFiles; ///< The files of each shader, by #line index.
+    };
+
+    /**
+     * @brief Replaces the program by its reloaded version if it is built.
+     * @return Whether the program was replaced.
+     */
+    bool swapReplacement();
+
+    /**
+     * @brief Loads the program from its cached binary, or submits the compilation of its shaders
+     * and its link. Waits for the sources to be read.
+     * @throws std::runtime_error If a file can't be read.
+     */
+    void submit();
+
+    /**
+     * @brief Checks the results of the compilation and the link, stores the binary in the cache
+     * and finds the uniforms. Waits for the driver to be done.
+     * @throws std::runtime_error If a shader fails to compile or the program fails to link.
+     */
+    void finish();
+
+    /**
+     * @brief Submits the compilation of the shaders, attaches them and links the program.
+     * @param sources The source code of each of the shaders.
+     */
+    void link(const std::vector<std::string>& sources);
+
+    /**
+     * @brief Checks whether a shader compiled.
+     * @param path The path to the shader file.
+     * @param shader The shader's id.
+     * @param sourceFiles The files the shader was read from, by their index in its #line
+     * directives. Listed in the error message.
+     * @throws std::runtime_error If the shader failed to compile.
+     */
+    void checkShader(const std::string& path, unsigned int shader,
+                     const std::vector<std::string>& sourceFiles) const;
+
+    /**
+     * @brief Finds the type of a shader from the extension of its file.
+     * @param path The path to the shader file.
+     * @return The type of the shader and its name.
+     */
+    static std::pair<unsigned int, std::string> getShaderType(const std::string& path);
+
+    /**
+     * @brief Computes where the binary of the program is cached, from a hash of the preprocessed
+     * sources, which hold the definitions of the variant, the transform feedback varyings and the
+     * driver's strings.
+     * @param paths The paths to each of the different shaders.
+     * @param sources The preprocessed source code of each of the shaders.
+     * @param varyings The outputs captured with transform feedback.
+     * @return The path of the cached binary, empty if the driver doesn't support program binaries.
+     */
+    static std::string getCachePath(const std::string* paths, const std::vector<std::string>& sources,
+                                    const std::vector<std::string>& varyings);
+
+    /**
+     * @brief Loads the program from a cached binary.
+     * @param path The path of the cached binary.
+     * @return Whether the binary exists and was accepted by the driver.
+     */
+    bool loadBinary(const std::string& path);
+
+    /**
+     * @brief Stores the binary of the linked program in the cache. Failures are ignored.
+     * @param path The path of the cached binary.
+     */
+    void saveBinary(const std::string& path) const;
+
+    /**
+     * @brief Reads the source code of a shader with its includes and adds the definitions of the
+     * macros after its #version directive, followed by a #line directive restoring the numbering
+     * of the file.
+     * @param path The path to the shader file.
+     * @param defines The macros to define.
+     * @param files Where to add the normalized paths of the files read.
+     * @param sourceFiles Where to store the files read, by their index in the #line directives.
+     * @return The preprocessed source code.
+     * @throws std::runtime_error If a file can't be opened or includes are nested too deeply.
+     */
+    static std::string preprocess(const std::string& path, const Defines& defines,
+                                  std::unordered_set<std::string>& files, std::vector<std::string>& sourceFiles);
+
+    /**
+     * @brief Reads the source code of a shader, replacing the '#include "path"' lines by the
+     * source code of the included files. A file that was already included is skipped. Each
+     * included file is surrounded by #line directives, so that errors report the line in the file
+     * they are in, with the index of the file in sourceFiles.
+     * @param path The path to the shader file.
+     * @param included The normalized paths of the files read so far.
+     * @param sourceFiles The files read so far, by their index in the #line directives.
+     * @param depth The amount of files including this one.
+     * @return The source code.
+     * @throws std::runtime_error If a file can't be opened or includes are nested too deeply.
+     */
+    static std::string readSource(const std::string& path, std::unordered_set<std::string>& included,
+                                  std::vector<std::string>& sourceFiles, unsigned int depth = 0);
+
+    /**
+     * @brief Prints that a uniform is unknown or unused, only the first time it is requested.
+     * @param uniform The uniform's name.
+     */
+    void warnUnknownUniform(const std::string& uniform);
+
 
     /**
      * @brief Sets the value of a uniform of type int.
@@ -185,8 +493,171 @@ private:
      */
     void setUniform(int location, const mat4& matrix) const;
 
+    /**
+     * @brief Sets the value of a uniform of type int of a shader program that may not be in use.
+     * @param program The shader program's id.
+     * @param location The uniform's location.
+     * @param value The new value of the uniform.
+     */
+    static void setProgramUniform(unsigned int program, int location, int value);
+
+    /**
+     * @brief Sets the value of a uniform of type unsigned int of a shader program that may not be in use.
+     * @param program The shader program's id.
+     * @param location The uniform's location.
+     * @param value The new value of the uniform.
+     */
+    static void setProgramUniform(unsigned int program, int location, unsigned int value);
+
+    /**
+     * @brief Sets the value of a uniform of type bool of a shader program that may not be in use.
+     * @param program The shader program's id.
+     * @param location The uniform's location.
+     * @param value The new value of the uniform.
+     */
+    static void setProgramUniform(unsigned int program, int location, bool value);
+
+    /**
+     * @brief Sets the value of a uniform of type float of a shader program that may not be in use.
+     * @param program The shader program's id.
+     * @param location The uniform's location.
+     * @param value The new value of the uniform.
+     */
+    static void setProgramUniform(unsigned int program, int location, float value);
+
+    /**
+     * @brief Sets the value of a uniform of type vec2 of a shader program that may not be in use.
+     * @param program The shader program's id.
+     * @param location The uniform's location.
+     * @param value The new value of the uniform.
+     */
+    static void setProgramUniform(unsigned int program, int location, const vec2& value);
+
+    /**
+     * @brief Sets the value of a uniform of type vec3 of a shader program that may not be in use.
+     * @param program The shader program's id.
+     * @param location The uniform's location.
+     * @param value The new value of the uniform.
+     */
+    static void setProgramUniform(unsigned int program, int location, const vec3& value);
+
+    /**
+     * @brief Sets the value of a uniform of type vec4 of a shader program that may not be in use.
+     * @param program The shader program's id.
+     * @param location The uniform's location.
+     * @param value The new value of the uniform.
+     */
+    static void setProgramUniform(unsigned int program, int location, const vec4& value);
+
+    /**
+     * @brief Sets the value of a uniform of type mat4 of a shader program that may not be in use.
+     * @param program The shader program's id.
+     * @param location The uniform's location.
+     * @param value The new value of the uniform.
+     */
+    static void setProgramUniform(unsigned int program, int location, const mat4& value);
+
+    static Shader* bound; ///< The shader program that is currently in use.
+    static unsigned int programCount;       ///< The amount of shader programs created.
+    static unsigned int cachedProgramCount; ///< The amount of shader programs loaded from the cache.
+    static float loadTime;                  ///< The time spent creating the shader programs in milliseconds.
+    static float reloadTime;                ///< The latency of the last reload in milliseconds.
+    static unsigned int uploadCount;        ///< The amount of uniform values sent since the last reset.
+    static unsigned int skippedUploadCount; ///< The amount of unchanged uniform values not sent.
+    static unsigned int skippedUseCount;    ///< The amount of programs not used as they already were.
+
     unsigned int id; ///< The shader program's id.
+    unsigned int generation; ///< Incremented whenever the program is replaced by its reloaded version.
     std::string name; ///< The shader's name.
+    int attributesLocation;      ///< The location of the 'attributes' uniform, -1 if it is unused.
     std::unordered_map<std::string, int> uniforms; ///< Stores uniforms id's.
+    std::unordered_map<int, UniformValue> values;  ///< The last value of each uniform by location.
     std::unordered_map<std::string, bool> unknownUniforms; ///< Stores unknown uniforms.
-};
\ No newline at end of file
+
+    State state;                                   ///< The step of the build of the program.
+    std::vector<std::string> paths;                ///< The paths to each of the different shaders.
+    std::vector<std::string> varyings;             ///< The outputs captured with transform feedback.
+    Defines defines;                               ///< The macros defined in each shader.
+    std::future<Sources> sources;                  ///< The preprocessed shaders, read on a worker thread.
+    std::unordered_set<std::string> files;         ///< The files the program is built from.
+    std::vector<std::vector<std::string>> sourceFiles; ///< The files of each shader, by #line index.
+    std::vector<unsigned int> stages;              ///< The shaders being compiled.
+    std::string cachePath;                         ///< The path of the cached binary of the program.
+    bool cached;                                   ///< Whether the program was loaded from the cache.
+
+    std::unique_ptr<Shader> replacement;              ///< The reloaded program being built, if any.
+    std::chrono::steady_clock::time_point reloadStart; ///< When the last reload was requested.
+};
+
+/**
+ * @class UniformHandle
+ * @brief A uniform of a shader program whose location was resolved once. Setting its value does
+ * not look it up by name and doesn't require the program to be in use. The location is resolved
+ * again after the program is reloaded. A default constructed handle, or one to an unknown or unused
+ * uniform, does nothing.
+ * @tparam T The type of the uniform: int, unsigned int, bool, float, vec2, vec3, vec4 or mat4.
+ */
+template<typename T>
+class UniformHandle {
+public:
+    /**
+     * @brief Creates a handle that does nothing.
+     */
+    UniformHandle() : shader(nullptr), generation(0), location(-1), value(nullptr) { }
+
+    /**
+     * @brief Creates a handle to a uniform and resolves its location.
+     * @param shader The shader program.
+     * @param uniform The uniform's name.
+     */
+    UniformHandle(Shader* shader, std::string uniform)
+        : shader(shader), uniform(std::move(uniform)) {
+
+        resolve();
+    }
+
+    /**
+     * @brief Sets the value of the uniform. Nothing is uploaded if the value didn't change.
+     * @param value The new value of the uniform.
+     */
+    void set(const T& value) const {
+        if(shader && generation != shader->generation) {
+            resolve();
+        }
+
+        if(location != -1 && this->value->update(value)) {
+            Shader::setProgramUniform(shader->id, location, value);
+        }
+    }
+
+    /**
+     * @brief Checks whether the uniform is used by the shader program.
+     * @return Whether setting the value of the uniform does something.
+     */
+    bool isActive() const {
+        if(shader && generation != shader->generation) {
+            resolve();
+        }
+
+        return location != -1;
+    }
+
+private:
+    /**
+     * @brief Looks the location of the uniform up in the current version of the program.
+     */
+    void resolve() const {
+        generation = shader->generation;
+
+        const auto found = shader->uniforms.find(uniform);
+        location = found == shader->uniforms.end() ? -1 : found->second;
+        value = location == -1 ? nullptr : &shader->values[location];
+    }
+
+    Shader* shader;      ///< The shader program, null if the handle does nothing.
+    std::string uniform; ///< The uniform's name.
+
+    mutable unsigned int generation;     ///< The generation of the program the location is from.
+    mutable int location;                ///< The uniform's location, -1 if it is unknown or unused.
+    mutable Shader::UniformValue* value; ///< The last value of the uniform.
+};
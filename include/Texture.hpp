@@ -6,21 +6,30 @@
 #pragma once
 
 #include "Image.hpp"
+#include "MipChain.hpp"
+#include <atomic>
+#include <future>
+#include <memory>
 #include <glm/vec3.hpp>
 
 using namespace glm;
 
 /**
  * @class Texture
- * @brief Creates a texture and assigns an image's data to it. Can then be bound.
+ * @brief Creates a texture and assigns an image's data to it. Can then be bound. The levels of an
+ * image file come from MipChain and can also be loaded on a worker thread, the texture then holds a
+ * placeholder color until poll uploads them.
  */
 class Texture {
 public:
     /**
-     * @brief Constructs a texture by loading an image and assigning its data to a new texture.
+     * @brief Constructs a texture by loading the levels of an image and assigning them to a new
+     * texture.
      * @param path The image's path.
+     * @param async Whether to load the levels on a worker thread, poll must then be called until
+     * the texture is ready. The texture can be bound meanwhile.
      */
-    Texture(const std::string& path);
+    Texture(const std::string& path, bool async = false);
 
     /**
      * @brief Constructs a texture by assigning an image's data to a new texture.
@@ -53,6 +62,41 @@ public:
      */
     void bind(unsigned int texUnit = 0) const;
 
+    /**
+     * @brief Uploads the levels loaded on a worker thread if they are done, without waiting for
+     * them. The texture keeps its id, so the texture units it is bound to show the image.
+     * @return Whether the texture is ready.
+     * @throws std::runtime_error If the image file can't be read or decoded.
+     */
+    bool poll();
+
+    /**
+     * @brief Checks whether the image of the texture was uploaded.
+     * @return Whether the texture is ready.
+     */
+    bool isReady() const;
+
+    /**
+     * @brief Getter for the loadTime member.
+     * @return The time spent by worker threads loading the levels of images in milliseconds.
+     */
+    static float getLoadTime();
+
 private:
+    /**
+     * @brief Assigns an image's data to the texture and generates its mipmaps.
+     * @param image The image.
+     */
+    void upload(const Image& image);
+
+    /**
+     * @brief Assigns precomputed levels to the texture.
+     * @param chain The levels.
+     */
+    void upload(const MipChain& chain);
+
+    static std::atomic<float> loadTime; ///< The time spent loading levels in milliseconds.
+
     unsigned int id; ///< Texture id.
+    std::future<std::unique_ptr<MipChain>> levels; ///< The levels being loaded, if any.
 };
\ No newline at end of file
@@ -5,11 +5,16 @@
 
 #pragma once
 
+#include <functional>
+#include <span>
+#include <type_traits>
 #include <vector>
 #include "glm/vec2.hpp"
 #include "glm/vec3.hpp"
 #include "glm/vec4.hpp"
 #include "Shader.hpp"
+#include "mesh/clustering.hpp"
+#include "mesh/handles.hpp"
 
 using namespace glm;
 
@@ -19,6 +24,41 @@ using namespace glm;
  */
 class Mesh {
 public:
+    /**
+     * @enum Attribute
+     * @brief Bit masks of the vertex attributes a mesh can have. They can be combined to describe
+     * the layout of the vertices.
+     */
+    enum Attribute : u_int8_t {
+        POSITION = 0b00000001,
+        NORMAL = 0b00000010,
+        TEX_COORDS = 0b00000100,
+        COLOR = 0b00001000,
+        INSTANCED = 0b00010000 ///< Not part of the vertices. Set when the mesh has per-instance attributes.
+    };
+
+    static constexpr unsigned int FIRST_INSTANCE_LOCATION = 4; ///< Location of the first per-instance attribute.
+
+    /**
+     * @struct LOD
+     * @brief A level of detail of the mesh, stored as a range of its indices.
+     */
+    struct LOD {
+        unsigned int firstIndex; ///< The position of the level's first index.
+        unsigned int indexCount; ///< The amount of indices of the level.
+        float error;             ///< The distance by which the surface moved from the original.
+    };
+
+    /**
+     * @enum Retention
+     * @brief What happens to the data and indices kept on the CPU once they were uploaded.
+     */
+    enum Retention : u_int8_t {
+        KEEP,          ///< Everything is kept so that the mesh can be uploaded again.
+        RELEASE,       ///< Everything is released. Uploading again requires a regenerator.
+        KEEP_POSITIONS ///< Only the positions and the indices are kept, e.g. for collision queries.
+    };
+
     /**
      * @brief Constructs a Mesh with a certain primitive and generates a VAO, a VBO and an EBO.
      * @param primitive The primitive. Can be one of:\n
@@ -26,32 +66,126 @@ public:
      *   GL_LINES\n
      *   GL_TRIANGLES\n
      *   etc…
+     * @param attributes The attributes the vertices will have. Only needs to be specified when
+     * using reserve or addVertices before any attribute was added individually. The position is
+     * always enabled.
+     */
+    Mesh(unsigned int primitive, u_int8_t attributes = POSITION);
+
+    /**
+     * @brief Constructs a Mesh by taking already built data and indices.
+     * @param primitive The primitive.
+     * @param attributes The attributes of the vertices in the data.
+     * @param data The vertices' attributes, interleaved in the same order as the data member.
+     * @param indices The indices. Can be empty.
      */
-    Mesh(unsigned int primitive);
+    Mesh(unsigned int primitive, u_int8_t attributes,
+         std::vector<float>&& data, std::vector<unsigned int>&& indices);
 
     /**
-     * @brief Constructs a Mesh with the same data as another.
+     * @brief Constructs a Mesh with the same data as another. Generates its own VAO, VBO and EBO.
      * @param mesh The mesh to copy.
      */
     Mesh(const Mesh& mesh);
 
     /**
-     * @brief Copies a mesh's data in this one.
+     * @brief Copies a mesh's data in this one. Regenerates the VAO, the VBO and the EBO.
      * @param mesh The mesh to copy.
      * @return A reference to this mesh.
      */
     Mesh& operator= (const Mesh& mesh);
 
     /**
-     * @brief Deletes the VAO, the VBO and the EBO.
+     * @brief Constructs a Mesh by taking the data and the VAO, VBO and EBO of another one.
+     * @param mesh The mesh to move. Can only be assigned to or destroyed afterwards.
      */
-    ~Mesh();
+    Mesh(Mesh&& mesh) noexcept = default;
 
     /**
-     * @brief Renders the mesh.
+     * @brief Deletes this mesh's VAO, VBO and EBO and takes the data and the VAO, VBO and EBO of
+     * another one.
+     * @param mesh The mesh to move. Can only be assigned to or destroyed afterwards.
+     * @return A reference to this mesh.
+     */
+    Mesh& operator= (Mesh&& mesh) noexcept = default;
+
+    /**
+     * @brief Renders the mesh with the shader program that is currently in use.
      */
     void draw();
 
+    /**
+     * @brief Uploads the mesh if needed, binds its VAO and gives its attributes to the shader
+     * program in use, so that draw calls can be issued directly.
+     */
+    void bind();
+
+    /**
+     * @brief Renders several instances of the mesh. The per-instance attributes must have been
+     * set with setInstanceAttribute or setInstanceLayout beforehand.
+     * @param count The amount of instances to render.
+     */
+    void drawInstanced(unsigned int count);
+
+    /**
+     * @brief Renders all the instances last given to setInstances.
+     */
+    void drawInstanced();
+
+    /**
+     * @brief Declares the per-instance attributes stored in the mesh's own instance buffer. They
+     * are floats interleaved in the given order, and use consecutive locations starting at
+     * FIRST_INSTANCE_LOCATION. Also enables the INSTANCED attribute.
+     * @param components The amount of components of each per-instance attribute (1 to 4).
+     */
+    void setInstanceLayout(const std::vector<unsigned int>& components);
+
+    /**
+     * @brief Replaces the values of the instances in the instance buffer. The layout must have
+     * been set with setInstanceLayout beforehand.
+     * @param instances The per-instance attributes, interleaved according to the layout.
+     */
+    void setInstances(std::span<const float> instances);
+
+    /**
+     * @brief Getter for the instanceCount member.
+     * @return The amount of instances last given to setInstances.
+     */
+    unsigned int getInstanceCount() const;
+
+    /**
+     * @brief Sources a vertex attribute from a buffer of per-instance values instead of the mesh's
+     * data. The attribute advances once per instance.
+     * @param location The attribute's location in the shader. Must not be used by the mesh's data.
+     * @param buffer The buffer containing the per-instance values.
+     * @param components The amount of components of the attribute (1 to 4).
+     * @param type The type of the values, e.g. GL_FLOAT, GL_UNSIGNED_SHORT, etc…
+     * @param normalized Whether integer values should be normalized to [0 ; 1].
+     * @param offset The offset of the first value in the buffer in bytes.
+     */
+    void setInstanceAttribute(unsigned int location, unsigned int buffer, int components,
+                              unsigned int type, bool normalized, unsigned int offset);
+
+    /**
+     * @brief Reserves memory so that adding a certain amount of vertices and indices doesn't
+     * reallocate. The vertices' size depends on the currently enabled attributes.
+     * @param vertices The total amount of vertices the mesh will have.
+     * @param indices The total amount of indices the mesh will have.
+     */
+    void reserve(unsigned int vertices, unsigned int indices);
+
+    /**
+     * @brief Adds several vertices to the data at once.
+     * @param vertices The vertices' attributes, interleaved in the same order as the data.
+     */
+    void addVertices(std::span<const float> vertices);
+
+    /**
+     * @brief Adds several indices to the indices at once.
+     * @param indices The indices.
+     */
+    void addIndices(std::span<const unsigned int> indices);
+
     /**
      * @brief Adds a position to the data.
      * @param x, y, z The point's coordinates.
@@ -118,6 +252,134 @@ public:
      */
     void addFace(unsigned int topL, unsigned int bottomL, unsigned int bottomR, unsigned int topR);
 
+    /**
+     * @brief Builds a chain of simplified levels of detail. Each level is simplified from the
+     * previous one and its indices are added after the others, sharing the same vertices. The
+     * first level is the mesh itself. Only applies to indexed triangle lists whose data is retained.
+     * @param ratios The amount of triangles of each new level relative to the original mesh.
+     * @param maxError The largest error a level can have, in the mesh's units. Levels stop being
+     * added once it is reached.
+     */
+    void generateLODs(std::span<const float> ratios, float maxError);
+
+    /**
+     * @brief Chooses the coarsest level of detail whose error is small enough at a certain distance.
+     * @param distance The distance from the camera to the mesh.
+     * @param tolerance The largest error allowed per unit of distance.
+     * @return The index of the level of detail.
+     */
+    unsigned int selectLOD(float distance, float tolerance) const;
+
+    /**
+     * @brief Sets the level of detail used when drawing.
+     * @param lod The index of the level of detail.
+     */
+    void setLOD(unsigned int lod);
+
+    /**
+     * @brief Getter for the lods member.
+     * @return The levels of detail of the mesh. Empty if none were generated.
+     */
+    const std::vector<LOD>& getLODs() const;
+
+    /**
+     * @brief Splits the first level of detail in clusters of neighbouring triangles that can be
+     * culled separately. The indices are reordered so that each cluster is contiguous. Only
+     * applies to indexed triangle lists whose data is retained.
+     * @param maxTriangles The largest amount of triangles in a cluster.
+     * @param maxVertices The largest amount of distinct vertices in a cluster.
+     */
+    void buildClusters(unsigned int maxTriangles = 124, unsigned int maxVertices = 64);
+
+    /**
+     * @brief Getter for the clusters member.
+     * @return The clusters of the mesh. Empty if they weren't built.
+     */
+    const std::vector<Clustering::Cluster>& getClusters() const;
+
+    /**
+     * @brief Renders some of the mesh's clusters with a single call.
+     * @param visible The positions of the clusters to draw in the clusters member, e.g. as
+     * returned by Clustering::cull.
+     */
+    void drawClusters(std::span<const unsigned int> visible);
+
+    /**
+     * @brief Reorders the triangles for the post-transform vertex cache, then the vertices in the
+     * order they are first used. Each level of detail and cluster is reordered separately. Only applies to indexed triangle lists whose data is retained.
+     * The mesh is uploaded again before the next draw.
+     */
+    void optimize();
+
+    /**
+     * @brief Calculates the average cache miss ratio of the mesh's indices with a simulated FIFO
+     * cache.
+     * @param cacheSize The amount of vertices the simulated cache holds.
+     * @return The amount of vertices transformed per triangle of the first level of detail, 0 if
+     * the mesh isn't an indexed triangle list.
+     */
+    float getACMR(unsigned int cacheSize = 16) const;
+
+    /**
+     * @brief Sets whether the attributes should be quantized when uploaded to the GPU. Normals are
+     * then packed in 10 bits per component, texture coordinates are stored as half floats and
+     * colors as 8-bit normalized values. Positions are left untouched.
+     * @param quantized Whether to quantize the attributes.
+     */
+    void setQuantized(bool quantized);
+
+    /**
+     * @brief Getter for the gpuSize member.
+     * @return The amount of bytes the mesh's buffers take on the GPU. 0 until it is first drawn.
+     */
+    unsigned int getGPUSize() const;
+
+    /**
+     * @brief Getter for the savedGPUSize member.
+     * @return The amount of bytes saved on the GPU by using 16-bit indices and quantization,
+     * compared to uploading 32-bit indices and floats.
+     */
+    unsigned int getSavedGPUSize() const;
+
+    /**
+     * @brief Sets what is kept on the CPU once the mesh was uploaded. Applies on the next upload.
+     * @param retention The retention policy.
+     */
+    void setRetention(Retention retention);
+
+    /**
+     * @brief Sets the function used to rebuild the data and indices when the mesh has to be
+     * uploaded again after they were released.
+     * @param regenerator A function returning a mesh with the same layout. Its data, indices,
+     * attributes, levels of detail and clusters replace those of this mesh.
+     */
+    void setRegenerator(std::function<Mesh()> regenerator);
+
+    /**
+     * @brief Uploads the mesh again before the next draw. The regenerator is called if there is
+     * one, otherwise the retained data is used.
+     * @throws std::runtime_error If the data was released and there is no regenerator.
+     */
+    void reupload();
+
+    /**
+     * @brief Calculates the memory taken by the data and indices kept on the CPU.
+     * @return The amount of bytes allocated for the data and indices.
+     */
+    unsigned int getCPUSize() const;
+
+    /**
+     * @brief Calculates the stride of vertices with certain attributes.
+     * @param attributes The attributes' bit masks.
+     * @return The amount of floats between a vertex attribute's value and the next.
+     */
+    static constexpr unsigned int getStride(u_int8_t attributes) {
+        return 3
+               + 3 * ((attributes & NORMAL) != 0)
+               + 2 * ((attributes & TEX_COORDS) != 0)
+               + 3 * ((attributes & COLOR) != 0);
+    }
+
     /**
      * @brief Getter for the primitive member.
      * @return The primitive of the mesh.
@@ -132,7 +394,8 @@ public:
 
     /**
      * @brief Getter fot the data member.
-     * @return The data of the mesh.
+     * @return The data of the mesh. Once uploaded, it is empty with the RELEASE policy and only
+     * contains the positions with the KEEP_POSITIONS policy.
      */
     const std::vector<float>* getData() const;
 
@@ -142,26 +405,84 @@ public:
      */
     const std::vector<unsigned int>* getIndices() const;
 
+    /**
+     * @brief Getter for the copyCount member.
+     * @return The amount of meshes copied so far. Meshes are meant to be moved, so any copy is
+     * worth looking at.
+     */
+    static unsigned int getCopyCount();
+
 private:
+    friend class MeshCache; // Saves and restores the uploaded buffers directly
+
+    /**
+     * @brief Uploads the data if needed, regenerating it first if it was released, then applies
+     * the retention policy.
+     * @throws std::runtime_error If the data was released and there is no regenerator.
+     */
+    void upload();
+
     /**
      * @brief Binds the data to the VBO correctly. If indices were sepcified also binds the
      * corresponding data the EBO. Binds the VBO (and the EBO if available) to the VAO.
      */
     void bindBuffers();
 
+    /**
+     * @brief Quantizes the data in the layout described by setQuantized.
+     * @return The quantized vertices.
+     */
+    std::vector<unsigned char> packQuantizedData() const;
+
+    /**
+     * @brief Sets the VAO's attributes according to the enabled attributes and whether they are
+     * quantized. The VAO and the VBO must be bound.
+     */
+    void setAttributePointers();
+
+    /**
+     * @brief Calculates the size of a vertex once uploaded, depending on whether it is quantized.
+     * @return The amount of bytes between a vertex and the next in the VBO.
+     */
+    unsigned int getVertexSize() const;
+
     /**
      * @brief Calculates the stride according to which attributes are enabled.
      * @return The stride between a vertex attribute's value and the next.
      */
     unsigned int getStride() const;
 
+    static unsigned int copyCount; ///< The amount of meshes copied so far.
+
     unsigned int primitive; ///< 3D Primitive used to draw. e.g. GL_TRIANGLES, GL_LINES, etc…
 
     bool shouldBind; ///< Whether the buffer should be bound before drawing.
+    bool quantized;  ///< Whether the attributes are quantized when uploaded.
+    bool released;   ///< Whether the data was totally or partially released after the last upload.
 
-    unsigned int VAO; ///< Vertex Array Object
-    unsigned int VBO; ///< Vertex Buffer Object
-    unsigned int EBO; ///< Element Buffer Object
+    Retention retention;                ///< What is kept on the CPU after uploading.
+    std::function<Mesh()> regenerator;  ///< Rebuilds the data after it was released. Can be empty.
+
+    unsigned int vertexCount; ///< The amount of uploaded vertices.
+    unsigned int indexCount;  ///< The amount of uploaded indices.
+
+    std::vector<LOD> lods; ///< The levels of detail. Empty if none were generated.
+    unsigned int lod;      ///< The level of detail used when drawing.
+
+    std::vector<Clustering::Cluster> clusters; ///< Clusters of the first level of detail. Can be empty.
+
+    unsigned int indexType;    ///< The type of the uploaded indices: GL_UNSIGNED_SHORT or GL_UNSIGNED_INT.
+    unsigned int gpuSize;      ///< The amount of bytes uploaded to the GPU.
+    unsigned int savedGPUSize; ///< The amount of bytes saved by using smaller types on the GPU.
+
+    VertexArray VAO; ///< Vertex Array Object
+    Buffer VBO;      ///< Vertex Buffer Object
+    Buffer EBO;      ///< Element Buffer Object
+    Buffer IBO;      ///< Instance Buffer Object
+
+    std::vector<unsigned int> instanceComponents; ///< Components of each per-instance attribute.
+    unsigned int instanceStride;                  ///< Amount of floats per instance.
+    unsigned int instanceCount;                   ///< Amount of instances in the instance buffer.
 
     /**
      * Bit masks for which attributes are enabled. For now the attributes are from right to
@@ -169,7 +490,8 @@ private:
      *   Position (vec3) : Is always enabled.\n
      *   Normal (vec3)\n
      *   Texture Coordinates (vec2)\n
-     *   Color (vec3)
+     *   Color (vec3)\n
+     *   Instanced : Whether per-instance attributes are sourced from the instance buffer.
      */
     u_int8_t attributes;
 
@@ -190,4 +512,7 @@ private:
      * will be drawn according to the primitive.
      */
     std::vector<unsigned int> indices;
-};
\ No newline at end of file
+};
+
+static_assert(!std::is_copy_constructible_v<VertexArray> && std::is_nothrow_move_constructible_v<Mesh>);
+static_assert(std::is_nothrow_move_assignable_v<Mesh>);
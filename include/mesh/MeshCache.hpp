@@ -0,0 +1,75 @@
+/***************************************************************************************************
+ * @file  MeshCache.hpp
+ * @brief Declaration of the MeshCache class
+ **************************************************************************************************/
+
+#pragma once
+
+#include <functional>
+#include <optional>
+#include <string>
+
+#include "mesh/Mesh.hpp"
+
+/**
+ * @class MeshCache
+ * @brief Stores generated meshes on disk in the format they are uploaded in, so that they are
+ * loaded instead of being generated again on the next startup. A file starts with a header holding
+ * the layout, the counts and the bounds of the mesh, followed by its levels of detail, then by the
+ * vertex and index blobs aligned on 16 bytes. Files are memory mapped and the blobs are given
+ * directly to the GPU.
+ */
+class MeshCache {
+public:
+    MeshCache() = delete;
+
+    /**
+     * @brief Loads a mesh from the cache, or generates it and stores it if it is not in the cache
+     * yet. The generator is used as the regenerator of the mesh.
+     * @param key Identifies the mesh and is used as its file name. Must contain every parameter of
+     * the generator, as a change of the generator is otherwise not noticed.
+     * @param generate Generates the mesh, including its levels of detail and quantization.
+     * @return The mesh, already uploaded if it was loaded from the cache.
+     */
+    static Mesh get(const std::string& key, const std::function<Mesh()>& generate);
+
+    /**
+     * @brief Stores a mesh in a file. The data of the mesh must not have been released.
+     * @param mesh The mesh.
+     * @param path The path of the file.
+     * @param generationTime The time it took to generate the mesh in milliseconds.
+     * @throws std::runtime_error If the data was released or the file can't be written.
+     */
+    static void save(const Mesh& mesh, const std::string& path, float generationTime);
+
+    /**
+     * @brief Loads a mesh from a file and uploads it. The mesh keeps no data on the CPU.
+     * @param path The path of the file.
+     * @param generationTime Where to write the time it took to generate the mesh. Can be null.
+     * @return The mesh, or nothing if the file is missing, invalid or of another version.
+     */
+    static std::optional<Mesh> load(const std::string& path, float* generationTime = nullptr);
+
+    /**
+     * @brief Getter for the hits member.
+     * @return The amount of meshes loaded from the cache.
+     */
+    static unsigned int getHits();
+
+    /**
+     * @brief Getter for the misses member.
+     * @return The amount of meshes that had to be generated.
+     */
+    static unsigned int getMisses();
+
+    /**
+     * @brief Getter for the savedTime member.
+     * @return The time saved by loading meshes instead of generating them in milliseconds.
+     */
+    static float getSavedTime();
+
+private:
+    static unsigned int hits;   ///< The amount of meshes loaded from the cache.
+    static unsigned int misses; ///< The amount of meshes that had to be generated.
+    static float savedTime;     ///< The time saved by loading meshes in milliseconds.
+};
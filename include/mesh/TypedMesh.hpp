@@ -0,0 +1,222 @@
+/***************************************************************************************************
+ * @file  TypedMesh.hpp
+ * @brief Declaration and implementation of the TypedMesh class
+ **************************************************************************************************/
+
+#pragma once
+
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "mesh/Mesh.hpp"
+
+/**
+ * Vertex attributes that can be used to describe the layout of a TypedMesh. They must be given in
+ * the same order as they are declared here, which is the order used by Mesh.
+ */
+namespace Attributes {
+    struct Position {
+        using Type = vec3;
+        static constexpr u_int8_t mask = Mesh::POSITION;
+        static constexpr unsigned int components = 3;
+    };
+
+    struct Normal {
+        using Type = vec3;
+        static constexpr u_int8_t mask = Mesh::NORMAL;
+        static constexpr unsigned int components = 3;
+    };
+
+    struct TexCoords {
+        using Type = vec2;
+        static constexpr u_int8_t mask = Mesh::TEX_COORDS;
+        static constexpr unsigned int components = 2;
+    };
+
+    struct Color {
+        using Type = vec3;
+        static constexpr u_int8_t mask = Mesh::COLOR;
+        static constexpr unsigned int components = 3;
+    };
+}
+
+/**
+ * @class TypedMesh
+ * @brief Builds the data of a mesh whose vertex layout is known at compile time. Vertices are added
+ * as whole structs and the stride and offsets of the attributes are constants. Once built, it is
+ * converted to a Mesh to be rendered.
+ * @tparam Attrs The attributes of the vertices, from the Attributes namespace.
+ */
+template<typename... Attrs>
+class TypedMesh {
+public:
+    static_assert(sizeof...(Attrs) > 0, "A mesh needs at least a position.");
+    static_assert(std::is_same_v<std::tuple_element_t<0, std::tuple<Attrs...>>, Attributes::Position>,
+                  "The first attribute must be the position.");
+
+    /**
+     * @brief Checks that the attributes are in the same order as in Mesh, which also ensures that
+     * none of them appears twice.
+     * @return Whether the attributes are correctly ordered.
+     */
+    static constexpr bool isOrdered() {
+        u_int8_t masks[]{Attrs::mask...};
+
+        for(unsigned int i = 1 ; i < sizeof...(Attrs) ; ++i) {
+            if(masks[i] <= masks[i - 1]) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    static_assert(isOrdered(), "The attributes must follow the order Position, Normal, TexCoords, Color.");
+
+    static constexpr u_int8_t attributes = (Attrs::mask | ...);        ///< Bit masks of the attributes.
+    static constexpr unsigned int stride = (Attrs::components + ...); ///< Amount of floats per vertex.
+
+    static_assert(stride == Mesh::getStride(attributes), "The layout differs from the one of Mesh.");
+
+    /**
+     * @brief Calculates the offset of an attribute in a vertex.
+     * @tparam Attr The attribute.
+     * @return The amount of floats preceding the attribute in a vertex.
+     */
+    template<typename Attr>
+    static constexpr unsigned int getOffset() {
+        static_assert((std::is_same_v<Attr, Attrs> || ...), "The attribute is not part of the layout.");
+
+        unsigned int offset = 0;
+        bool found = false;
+        ((found = found || std::is_same_v<Attr, Attrs>, offset += found ? 0 : Attrs::components), ...);
+
+        return offset;
+    }
+
+    /**
+     * @struct Vertex
+     * @brief A vertex with all of its attributes packed in the same layout as in the data.
+     */
+    struct Vertex {
+        /**
+         * @brief Constructs a vertex from the values of each of its attributes.
+         * @param values The values of the attributes, in the same order as the layout.
+         */
+        Vertex(const typename Attrs::Type&... values) {
+            (set<Attrs>(values), ...);
+        }
+
+        /**
+         * @brief Sets the value of one of the attributes.
+         * @tparam Attr The attribute.
+         * @param value The new value of the attribute.
+         */
+        template<typename Attr>
+        void set(const typename Attr::Type& value) {
+            for(unsigned int i = 0 ; i < Attr::components ; ++i) {
+                this->values[getOffset<Attr>() + i] = value[i];
+            }
+        }
+
+        float values[stride]; ///< The values of all the attributes.
+    };
+
+    static_assert(sizeof(Vertex) == stride * sizeof(float), "Vertices must be tightly packed.");
+    static_assert(std::is_standard_layout_v<Vertex>);
+
+    /**
+     * @brief Constructs an empty TypedMesh with a certain primitive.
+     * @param primitive The primitive, e.g. GL_TRIANGLES, GL_LINES, etc…
+     */
+    TypedMesh(unsigned int primitive) : primitive(primitive) { }
+
+    /**
+     * @brief Reserves memory so that adding a certain amount of vertices and indices doesn't
+     * reallocate.
+     * @param vertices The total amount of vertices the mesh will have.
+     * @param indices The total amount of indices the mesh will have.
+     */
+    void reserve(unsigned int vertices, unsigned int indices) {
+        data.reserve(vertices * stride);
+        this->indices.reserve(indices);
+    }
+
+    /**
+     * @brief Adds a vertex to the data.
+     * @param vertex The vertex.
+     */
+    void addVertex(const Vertex& vertex) {
+        data.insert(data.end(), vertex.values, vertex.values + stride);
+    }
+
+    /**
+     * @brief Adds several vertices to the data at once, with a single copy since they are laid out
+     * exactly like the data.
+     * @param vertices The vertices.
+     */
+    void addVertices(std::span<const Vertex> vertices) {
+        const float* values = reinterpret_cast<const float*>(vertices.data());
+        data.insert(data.end(), values, values + vertices.size() * stride);
+    }
+
+    /**
+     * @brief Adds an index to the indices.
+     * @param index The index.
+     */
+    void addIndex(unsigned int index) {
+        indices.push_back(index);
+    }
+
+    /**
+     * @brief Adds a triangle to the indices.
+     * @param top, left, right The triangle's indices.
+     */
+    void addTriangle(unsigned int top, unsigned int left, unsigned int right) {
+        indices.insert(indices.end(), {top, left, right});
+    }
+
+    /**
+     * @brief Adds a face to the indices.
+     * @param topL, bottomL, bottomR, topR The face's indices.
+     */
+    void addFace(unsigned int topL, unsigned int bottomL, unsigned int bottomR, unsigned int topR) {
+        indices.insert(indices.end(), {
+            topL, bottomL, bottomR, // First Triangle
+            topL, bottomR, topR     // Second Triangle
+        });
+    }
+
+    /**
+     * @brief Returns the amount of vertices added so far.
+     * @return The amount of vertices.
+     */
+    unsigned int getVertexCount() const {
+        return data.size() / stride;
+    }
+
+    /**
+     * @brief Creates a Mesh with a copy of the data and indices.
+     * @return The mesh.
+     */
+    Mesh toMesh() const& {
+        return Mesh(primitive, attributes, std::vector<float>(data), std::vector<unsigned int>(indices));
+    }
+
+    /**
+     * @brief Creates a Mesh by moving the data and indices into it. The TypedMesh is left empty.
+     * @return The mesh.
+     */
+    Mesh toMesh() && {
+        return Mesh(primitive, attributes, std::move(data), std::move(indices));
+    }
+
+private:
+    unsigned int primitive; ///< 3D Primitive used to draw. e.g. GL_TRIANGLES, GL_LINES, etc…
+
+    std::vector<float> data;           ///< Attributes data, laid out as consecutive vertices.
+    std::vector<unsigned int> indices; ///< Optional vertex indices.
+};
@@ -0,0 +1,77 @@
+/***************************************************************************************************
+ * @file  clustering.hpp
+ * @brief Declaration of functions to split meshes in clusters that can be culled separately
+ **************************************************************************************************/
+
+#pragma once
+
+#include <span>
+#include <vector>
+#include <glm/vec3.hpp>
+
+#include "Frustum.hpp"
+
+using namespace glm;
+
+/**
+ * Splitting of indexed triangle lists in small clusters of neighbouring triangles (meshlets), each
+ * with bounds allowing to cull it against the view frustum and when all of its triangles face away
+ * from the camera. The positions are expected to be in world space.
+ */
+namespace Clustering {
+    /**
+     * @struct Cluster
+     * @brief A group of neighbouring triangles stored as a range of indices.
+     */
+    struct Cluster {
+        unsigned int firstIndex; ///< The position of the cluster's first index.
+        unsigned int indexCount; ///< The amount of indices of the cluster.
+        vec3 center;             ///< The center of the bounding sphere.
+        float radius;            ///< The radius of the bounding sphere.
+        vec3 coneAxis;           ///< The average direction of the triangles' normals.
+        float coneCutoff;        ///< Sine of the angle between the axis and the furthest normal, 1 if above 90°.
+    };
+
+    /**
+     * @struct CullingStats
+     * @brief The amount of triangles accepted and rejected by each test during a culling pass.
+     */
+    struct CullingStats {
+        unsigned int frustumRejected = 0; ///< Triangles of clusters outside of the frustum.
+        unsigned int coneRejected = 0;    ///< Triangles of clusters facing away from the camera.
+        unsigned int accepted = 0;        ///< Triangles of the visible clusters.
+    };
+
+    /**
+     * @brief Groups the triangles in clusters by growing each one from a seed triangle with the
+     * neighbouring triangles adding the fewest vertices. The indices are reordered so that each
+     * cluster's triangles are contiguous.
+     * @param data The interleaved vertices. The first 3 floats of each vertex are its position.
+     * @param indices The indices of a triangle list. Modified in place.
+     * @param stride The amount of floats per vertex.
+     * @param maxTriangles The largest amount of triangles in a cluster.
+     * @param maxVertices The largest amount of distinct vertices in a cluster.
+     * @return The clusters.
+     */
+    std::vector<Cluster> build(std::span<const float> data, std::vector<unsigned int>& indices, unsigned int stride,
+                               unsigned int maxTriangles = 124, unsigned int maxVertices = 64);
+
+    /**
+     * @brief Checks whether all the triangles of a cluster face away from the camera.
+     * @param cluster The cluster.
+     * @param cameraPos The position of the camera.
+     * @return Whether the whole cluster is backfacing.
+     */
+    bool isBackfacing(const Cluster& cluster, const vec3& cameraPos);
+
+    /**
+     * @brief Finds the clusters that are in the frustum and not backfacing.
+     * @param clusters The clusters.
+     * @param frustum The view frustum.
+     * @param cameraPos The position of the camera.
+     * @param visible Filled with the positions of the visible clusters in the clusters span.
+     * @param stats Optional output for the amount of triangles rejected by each test.
+     */
+    void cull(std::span<const Cluster> clusters, const Frustum& frustum, const vec3& cameraPos,
+              std::vector<unsigned int>& visible, CullingStats* stats = nullptr);
+}
@@ -0,0 +1,111 @@
+/***************************************************************************************************
+ * @file  handles.hpp
+ * @brief Declaration of the VertexArray and Buffer classes
+ **************************************************************************************************/
+
+#pragma once
+
+#include <type_traits>
+
+/**
+ * @class VertexArray
+ * @brief Owns an OpenGL vertex array object. Cannot be copied, only moved.
+ */
+class VertexArray {
+public:
+    /**
+     * @brief Generates a vertex array object.
+     */
+    VertexArray();
+
+    VertexArray(const VertexArray&) = delete;
+    VertexArray& operator= (const VertexArray&) = delete;
+
+    /**
+     * @brief Takes ownership of another vertex array object.
+     * @param vertexArray The vertex array to move. Will not own any object afterwards.
+     */
+    VertexArray(VertexArray&& vertexArray) noexcept;
+
+    /**
+     * @brief Deletes the owned vertex array object and takes ownership of another one.
+     * @param vertexArray The vertex array to move. Will not own any object afterwards.
+     * @return A reference to this vertex array.
+     */
+    VertexArray& operator= (VertexArray&& vertexArray) noexcept;
+
+    /**
+     * @brief Deletes the vertex array object.
+     */
+    ~VertexArray();
+
+    /**
+     * @brief Returns the id of the vertex array object.
+     * @return The vertex array object's id, 0 if it was moved.
+     */
+    operator unsigned int() const;
+
+    /**
+     * @brief Getter for the createdCount member.
+     * @return The amount of vertex array objects generated so far, moves excluded.
+     */
+    static unsigned int getCreatedCount();
+
+private:
+    static unsigned int createdCount; ///< The amount of vertex array objects generated so far.
+
+    unsigned int id; ///< The vertex array object's id.
+};
+
+/**
+ * @class Buffer
+ * @brief Owns an OpenGL buffer object. Cannot be copied, only moved.
+ */
+class Buffer {
+public:
+    /**
+     * @brief Generates a buffer object.
+     */
+    Buffer();
+
+    Buffer(const Buffer&) = delete;
+    Buffer& operator= (const Buffer&) = delete;
+
+    /**
+     * @brief Takes ownership of another buffer object.
+     * @param buffer The buffer to move. Will not own any object afterwards.
+     */
+    Buffer(Buffer&& buffer) noexcept;
+
+    /**
+     * @brief Deletes the owned buffer object and takes ownership of another one.
+     * @param buffer The buffer to move. Will not own any object afterwards.
+     * @return A reference to this buffer.
+     */
+    Buffer& operator= (Buffer&& buffer) noexcept;
+
+    /**
+     * @brief Deletes the buffer object.
+     */
+    ~Buffer();
+
+    /**
+     * @brief Returns the id of the buffer object.
+     * @return The buffer object's id, 0 if it was moved.
+     */
+    operator unsigned int() const;
+
+    /**
+     * @brief Getter for the createdCount member.
+     * @return The amount of buffer objects generated so far, moves excluded.
+     */
+    static unsigned int getCreatedCount();
+
+private:
+    static unsigned int createdCount; ///< The amount of buffer objects generated so far.
+
+    unsigned int id; ///< The buffer object's id.
+};
+
+static_assert(!std::is_copy_constructible_v<VertexArray> && std::is_nothrow_move_constructible_v<VertexArray>);
+static_assert(!std::is_copy_constructible_v<Buffer> && std::is_nothrow_move_constructible_v<Buffer>);
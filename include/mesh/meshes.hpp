@@ -99,4 +99,11 @@ namespace Meshes {
      * that can be used to render things directly on the screen.
      */
     Mesh screen();
+
+    /**
+     * @brief Creates the mesh for a tuft of grass made of 3 crossed quads of height 1 that can be
+     * seen from both sides. Its base is centered at the origin. The normals all point upwards so
+     * that the grass is lit like the ground it grows on.
+     */
+    Mesh grassTuft();
 }
\ No newline at end of file
@@ -0,0 +1,42 @@
+/***************************************************************************************************
+ * @file  optimization.hpp
+ * @brief Declaration of functions to optimize the order of a mesh's vertices and indices
+ **************************************************************************************************/
+
+#pragma once
+
+#include <span>
+#include <vector>
+
+/**
+ * Passes reordering the triangles and vertices of indexed triangle lists so that they are faster to
+ * render. All of them run in linear time.
+ */
+namespace Optimization {
+    /**
+     * @brief Reorders the triangles so that the GPU's post-transform vertex cache is hit as often
+     * as possible, using Tom Forsyth's linear-speed algorithm.
+     * @param indices The indices of a triangle list. Modified in place.
+     * @param vertexCount The amount of vertices referenced by the indices.
+     */
+    void optimizeVertexCache(std::vector<unsigned int>& indices, unsigned int vertexCount);
+
+    /**
+     * @brief Reorders the vertices in the order they are first used by the indices so that they
+     * are fetched sequentially. Unused vertices are moved at the end.
+     * @param data The interleaved vertices. Modified in place.
+     * @param indices The indices, remapped to the new order of the vertices.
+     * @param stride The amount of floats per vertex.
+     */
+    void optimizeVertexFetch(std::vector<float>& data, std::vector<unsigned int>& indices, unsigned int stride);
+
+    /**
+     * @brief Simulates a FIFO post-transform vertex cache to calculate the average cache miss
+     * ratio (ACMR) of a triangle list, i.e. the amount of vertices transformed per triangle.
+     * @param indices The indices of a triangle list.
+     * @param vertexCount The amount of vertices referenced by the indices.
+     * @param cacheSize The amount of vertices the simulated cache holds.
+     * @return The ACMR, between 0.5 for an ideal mesh and 3 for the worst order.
+     */
+    float getACMR(std::span<const unsigned int> indices, unsigned int vertexCount, unsigned int cacheSize = 16);
+}
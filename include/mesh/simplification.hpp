@@ -0,0 +1,33 @@
+/***************************************************************************************************
+ * @file  simplification.hpp
+ * @brief Declaration of functions to simplify meshes with quadric error metrics
+ **************************************************************************************************/
+
+#pragma once
+
+#include <span>
+#include <vector>
+
+/**
+ * Simplification of indexed triangle lists by collapsing edges onto existing vertices, so that the
+ * simplified indices can share the original vertices. The functions don't touch any global state
+ * and can be called from worker threads.
+ */
+namespace Simplification {
+    /**
+     * @brief Collapses the edges whose quadric error is the lowest until the target amount of
+     * triangles or the maximum error is reached. Vertices on borders and vertices sharing their
+     * position with another one (e.g. on texture seams) are never moved.
+     * @param data The interleaved vertices. The first 3 floats of each vertex are its position.
+     * @param indices The indices of a triangle list.
+     * @param stride The amount of floats per vertex.
+     * @param targetTriangles The amount of triangles to reach.
+     * @param maxError The largest distance a collapse can move the surface, in the mesh's units.
+     * @param error Optional output for the largest error of the collapses that were made.
+     * @return The indices of the simplified triangles. They can be more than targetTriangles if
+     * the maximum error was reached first.
+     */
+    std::vector<unsigned int> simplify(std::span<const float> data, std::span<const unsigned int> indices,
+                                       unsigned int stride, unsigned int targetTriangles, float maxError,
+                                       float* error = nullptr);
+}
@@ -0,0 +1,56 @@
+/***************************************************************************************************
+ * @file  quality.hpp
+ * @brief Declaration of the quality tiers of the shaders
+ **************************************************************************************************/
+
+#pragma once
+
+#include "Shader.hpp"
+
+/**
+ * Presets trading the quality of the terrain, the water and the clouds for frame time. Each tier
+ * is compiled into specialized shader programs through macros rather than uniforms, so that the
+ * loops have constant bounds. The shape of the terrain is the same on every tier, only its
+ * tessellation changes, since the vegetation is placed with the CPU height module.
+ */
+namespace Quality {
+    /**
+     * @enum Tier
+     * @brief The quality presets.
+     */
+    enum Tier {
+        LOW,
+        MEDIUM,
+        HIGH
+    };
+
+    /**
+     * @struct Settings
+     * @brief The values of the macros of a tier.
+     */
+    struct Settings {
+        const char* name;            ///< The name of the tier, shown in the debug window.
+        unsigned int tessLevel;      ///< MAX_TESS_LEVEL in shaders/terrain/terrain.tesc.
+        unsigned int cloudSteps;     ///< CLOUD_STEPS in shaders/clouds/clouds.frag.
+        unsigned int cloudOctaves;   ///< CLOUD_OCTAVES in shaders/clouds/clouds.frag.
+        unsigned int voronoiRange;   ///< VORONOI_RANGE in shaders/clouds/clouds.frag.
+        unsigned int waterSteps;     ///< MAX_STEPS in shaders/water/water.frag.
+        unsigned int waveOctaves;    ///< WAVE_OCTAVES in shaders/water/water.frag.
+    };
+
+    /**
+     * The settings of each tier. HIGH matches the defaults of the shaders.
+     */
+    constexpr Settings TIERS[] = {
+        {"Low",     8,  150, 2, 0,  32,  5},
+        {"Medium", 16,  400, 3, 1,  64,  8},
+        {"High",   32, 1000, 4, 1, 128, 12}
+    };
+
+    /**
+     * @brief Returns the macros to define in the shader programs for a tier.
+     * @param tier The tier.
+     * @return The definitions of the macros.
+     */
+    Shader::Defines getDefines(Tier tier);
+}
@@ -0,0 +1,122 @@
+/***************************************************************************************************
+ * @file  TerrainCapture.hpp
+ * @brief Declaration of the TerrainCapture class
+ **************************************************************************************************/
+
+#pragma once
+
+#include <vector>
+#include <glm/vec2.hpp>
+
+#include "mesh/Mesh.hpp"
+#include "mesh/handles.hpp"
+
+using namespace glm;
+
+/**
+ * @class TerrainCapture
+ * @brief Captures the positions and normals output by shaders/terrain/terrain.tese with transform
+ * feedback, then reads them back once the GPU is done so that the frame never waits for it. The
+ * shader program must be linked with the 'position' and 'normal' outputs as interleaved transform
+ * feedback varyings. Cannot be copied.
+ */
+class TerrainCapture {
+public:
+    static constexpr unsigned int VERTEX_STRIDE = 6; ///< Amount of floats per captured vertex.
+
+    /**
+     * @brief Creates the buffer receiving the captured triangles and the queries.
+     * @param maxTriangles The amount of triangles the buffer can hold.
+     */
+    TerrainCapture(unsigned int maxTriangles);
+
+    TerrainCapture(const TerrainCapture&) = delete;
+    TerrainCapture& operator= (const TerrainCapture&) = delete;
+
+    /**
+     * @brief Deletes the queries and the fence of a pending capture.
+     */
+    ~TerrainCapture();
+
+    /**
+     * @brief Starts capturing the triangles of the following draw calls. Rasterization is
+     * disabled until end is called. Does nothing if a capture is already pending.
+     * @return Whether the capture started.
+     */
+    bool begin();
+
+    /**
+     * @brief Stops capturing and places a fence to know when the results can be read.
+     */
+    void end();
+
+    /**
+     * @brief Reads the results of the pending capture back if the GPU finished it, then compares
+     * the captured heights with the CPU height module. Never waits for the GPU.
+     * @return Whether a new capture is available.
+     */
+    bool poll();
+
+    /**
+     * @brief Checks whether a capture was made but not read back yet.
+     * @return Whether a capture is pending.
+     */
+    bool isPending() const;
+
+    /**
+     * @brief Getter for the vertices member.
+     * @return The vertices of the last capture, as interleaved positions and normals. Every three
+     * vertices make a triangle.
+     */
+    const std::vector<float>& getVertices() const;
+
+    /**
+     * @brief Creates a mesh from the last capture, e.g. to export it or to use it as a collision
+     * mesh snapshot.
+     * @return The non indexed mesh with positions and normals.
+     */
+    Mesh toMesh() const;
+
+    /**
+     * @brief Returns the amount of triangles of the last capture.
+     * @return The amount of captured triangles.
+     */
+    unsigned int getTriangleCount() const;
+
+    /**
+     * @brief Getter for the truncated member.
+     * @return Whether the last capture generated more triangles than the buffer could hold.
+     */
+    bool isTruncated() const;
+
+    /**
+     * @brief Getter for the gpuTime member.
+     * @return The GPU time spent on the captured draw calls in milliseconds.
+     */
+    float getGPUTime() const;
+
+    /**
+     * @brief Getter for the readbackTime member.
+     * @return The CPU time spent reading the last capture back in milliseconds.
+     */
+    float getReadbackTime() const;
+
+    /**
+     * @brief Getter for the heightError member.
+     * @return The mean and the maximum absolute difference between the captured heights and the
+     * ones of the CPU height module.
+     */
+    vec2 getHeightError() const;
+
+private:
+    Buffer buffer;               ///< The buffer receiving the captured vertices.
+    const unsigned int capacity; ///< The amount of triangles the buffer can hold.
+    unsigned int queries[3];     ///< Primitives generated, primitives written and time elapsed.
+    void* fence;                 ///< Signaled once the pending capture is done. Null if none is.
+
+    std::vector<float> vertices; ///< The vertices of the last capture.
+    bool truncated;              ///< Whether the last capture didn't fit in the buffer.
+    float gpuTime;               ///< The GPU time of the last capture in milliseconds.
+    float readbackTime;          ///< The CPU time of the last readback in milliseconds.
+    vec2 heightError;            ///< Mean and maximum error of the captured heights.
+};
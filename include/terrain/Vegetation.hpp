@@ -0,0 +1,259 @@
+/***************************************************************************************************
+ * @file  Vegetation.hpp
+ * @brief Declaration of the Vegetation class
+ **************************************************************************************************/
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <glm/mat4x4.hpp>
+
+#include "Shader.hpp"
+#include "mesh/Mesh.hpp"
+
+using namespace glm;
+
+/**
+ * @class Vegetation
+ * @brief Scatters grass and rocks on the terrain around the camera. The terrain is split in square
+ * tiles whose instances are placed on worker threads using the CPU height module, then uploaded in
+ * one buffer per tile and drawn with instanced draws after being frustum culled.
+ */
+class Vegetation {
+public:
+    /**
+     * @brief Starts the worker threads and creates the meshes.
+     * @param tileSize The side length of a tile.
+     * @param radius The amount of tiles around the camera's tile that will be populated.
+     */
+    Vegetation(float tileSize, int radius);
+
+    /**
+     * @brief Stops the worker threads. The tiles' buffers are deleted with the tiles.
+     */
+    ~Vegetation();
+
+    /**
+     * @brief Requests the tiles that came in range of the camera, uploads the ones that finished
+     * being generated and deletes the ones that went out of range.
+     * @param cameraPos The position of the camera.
+     */
+    void update(const vec3& cameraPos);
+
+    /**
+     * @brief Culls the tiles and draws the visible instances. The shader program must be in use.
+     * @param shader The shader program used to render the vegetation.
+     * @param vpMatrix The view/projection matrix.
+     * @param cameraPos The position of the camera.
+     */
+    void draw(Shader& shader, const mat4& vpMatrix, const vec3& cameraPos);
+
+    /**
+     * @brief Getter for the drawnInstances member.
+     * @return The amount of instances drawn during the last frame.
+     */
+    unsigned int getDrawnInstances() const;
+
+    /**
+     * @brief Getter for the cullingTime member.
+     * @return The CPU time spent culling the tiles during the last frame in milliseconds.
+     */
+    float getCullingTime() const;
+
+    /**
+     * @brief Returns the amount of tiles currently uploaded.
+     * @return The amount of tiles ready to be drawn.
+     */
+    unsigned int getTileCount() const;
+
+    /**
+     * @brief Getter for the storedInstances member.
+     * @return The amount of instances stored in all the uploaded tiles.
+     */
+    unsigned int getStoredInstances() const;
+
+    /**
+     * @brief Returns the levels of detail of the rock mesh.
+     * @return The rock's levels of detail.
+     */
+    const std::vector<Mesh::LOD>& getRockLODs() const;
+
+    /**
+     * @brief Checks whether the rock was loaded from the mesh cache, in which case its levels of
+     * detail were not generated and the rock's ACMR and LOD throughput are unknown.
+     * @return Whether the rock was loaded from the mesh cache.
+     */
+    bool isRockCached() const;
+
+    /**
+     * @brief Getter for the lodThroughput member.
+     * @return The amount of triangles simplified per second when generating the rock's levels of
+     * detail.
+     */
+    float getLODThroughput() const;
+
+    /**
+     * @brief Getter for the rockACMR member.
+     * @return The average cache miss ratio of the rock's most detailed level before and after it
+     * was optimized.
+     */
+    vec2 getRockACMR() const;
+
+    /**
+     * @brief Calculates the memory taken on the CPU by the grass and rock meshes.
+     * @return The amount of bytes retained by the meshes.
+     */
+    unsigned int getMeshCPUSize() const;
+
+    /**
+     * @brief Calculates the memory taken on the GPU by the grass and rock meshes. The instances
+     * are not included.
+     * @return The amount of bytes uploaded for the meshes.
+     */
+    unsigned int getMeshGPUSize() const;
+
+private:
+    /**
+     * @struct Instances
+     * @brief Per-instance values of one kind of vegetation in a tile, stored as a structure of
+     * arrays. Positions on the XZ plane are relative to the tile.
+     */
+    struct Instances {
+        std::vector<uint16_t> x;    ///< Normalized x coordinate in the tile.
+        std::vector<uint16_t> z;    ///< Normalized z coordinate in the tile.
+        std::vector<float> y;       ///< Height of the instance.
+        std::vector<uint8_t> scale; ///< Normalized scale of the instance.
+    };
+
+    /**
+     * @struct TileData
+     * @brief The result of the generation of a tile by a worker thread.
+     */
+    struct TileData {
+        ivec2 coords;    ///< The coordinates of the tile.
+        Instances grass; ///< The grass instances.
+        Instances rocks; ///< The rock instances.
+        float minY;      ///< The lowest height of an instance.
+        float maxY;      ///< The highest height of an instance.
+    };
+
+    /**
+     * @struct Tile
+     * @brief A tile living on the GPU.
+     */
+    struct Tile {
+        bool ready;                   ///< Whether the tile was generated and uploaded.
+        vec2 origin;                  ///< The position of the tile's corner on the XZ plane.
+        std::optional<Buffer> buffer; ///< The buffer containing the instances' values, if there are any.
+        unsigned int grassCount;      ///< The amount of grass instances.
+        unsigned int rockCount;       ///< The amount of rock instances.
+        unsigned int offsets[8];      ///< The offset of each of the arrays in the buffer.
+        float minY;                   ///< The lowest height of an instance.
+        float maxY;                   ///< The highest height of an instance.
+    };
+
+    /**
+     * @struct VisibleTile
+     * @brief A tile that passed culling along with how many of its instances should be drawn.
+     */
+    struct VisibleTile {
+        const Tile* tile;        ///< The tile.
+        unsigned int grassCount; ///< The amount of grass instances to draw.
+        unsigned int rockLOD;    ///< The level of detail of the rocks.
+    };
+
+    /**
+     * @struct Uniforms
+     * @brief Handles to the uniforms of the vegetation's shader program.
+     */
+    struct Uniforms {
+        UniformHandle<float> tileSize;  ///< The side length of a tile.
+        UniformHandle<vec2> tileOrigin; ///< The position of the tile's corner on the XZ plane.
+        UniformHandle<vec2> scaleRange; ///< The scales of the smallest and largest instances.
+        UniformHandle<vec3> stretch;    ///< The scale of the mesh on each axis.
+        UniformHandle<vec3> baseColor;  ///< The color of the mesh.
+    };
+
+    /**
+     * @brief Loop run by each of the worker threads. Generates the requested tiles.
+     */
+    void work();
+
+    /**
+     * @brief Generates the rock mesh and its levels of detail, optimizes it and measures the
+     * ACMR and LOD throughput.
+     * @return The rock mesh.
+     */
+    Mesh generateRock();
+
+    /**
+     * @brief Places the instances of a tile.
+     * @param coords The coordinates of the tile.
+     * @return The generated tile.
+     */
+    TileData generate(const ivec2& coords) const;
+
+    /**
+     * @brief Uploads a generated tile to a new buffer.
+     * @param data The generated tile.
+     * @return The uploaded tile.
+     */
+    static Tile upload(const TileData& data);
+
+    /**
+     * @brief Points the mesh's per-instance attributes to one of the arrays of a tile.
+     * @param mesh The mesh that will be drawn.
+     * @param tile The tile.
+     * @param first The index of the first of the 4 arrays of the kind of vegetation to draw.
+     */
+    static void bindInstances(Mesh& mesh, const Tile& tile, unsigned int first);
+
+    /**
+     * @brief Packs the coordinates of a tile in a single key.
+     * @param x, z The coordinates of the tile.
+     * @return The key corresponding to the tile.
+     */
+    static int64_t key(int x, int z);
+
+    const float tileSize; ///< The side length of a tile.
+    const int radius;     ///< The amount of tiles around the camera's tile that are populated.
+
+    const float grassDistance; ///< The distance at which grass stops being drawn.
+
+    Mesh grass;          ///< Mesh for a tuft of grass.
+    vec2 rockACMR;       ///< ACMR of the detailed rock mesh before and after optimization.
+    float lodThroughput; ///< The speed at which the rock's LODs were generated in triangles per second.
+    bool rockCached;     ///< Whether the rock was loaded from the mesh cache.
+    Mesh rock;           ///< Mesh for a rock, with several levels of detail. Loaded from the mesh cache.
+
+    Uniforms uniforms;            ///< Handles to the uniforms of the shader program.
+    const Shader* uniformsShader; ///< The shader program the handles were resolved for.
+
+    ivec2 cameraTile;    ///< The tile the camera was in during the last update.
+    bool hasCameraTile;  ///< Whether the tiles were already requested once.
+
+    std::unordered_map<int64_t, Tile> tiles; ///< The requested and uploaded tiles.
+
+    std::vector<std::thread> workers;  ///< The worker threads generating the tiles.
+    std::mutex mutex;                  ///< Guards the requests, results and stopping members.
+    std::condition_variable condition; ///< Wakes up the workers when tiles are requested.
+    std::deque<ivec2> requests;        ///< The tiles waiting to be generated.
+    std::vector<TileData> results;     ///< The generated tiles waiting to be uploaded.
+    bool stopping;                     ///< Whether the workers should stop.
+
+    std::vector<VisibleTile> visibleTiles; ///< The tiles that passed culling this frame.
+
+    unsigned int drawnInstances;  ///< The amount of instances drawn during the last frame.
+    unsigned int storedInstances; ///< The amount of instances in the uploaded tiles.
+    float cullingTime;            ///< The time spent culling during the last frame in milliseconds.
+};
@@ -0,0 +1,52 @@
+/***************************************************************************************************
+ * @file  height.hpp
+ * @brief Declaration of functions to sample the terrain's height on the CPU
+ **************************************************************************************************/
+
+#pragma once
+
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+
+using namespace glm;
+
+/**
+ * CPU port of the height function used in shaders/terrain/terrain.tese and of the texture weights
+ * used in shaders/terrain/terrain.frag. Any change made to the shaders must be reflected here.
+ */
+namespace Terrain {
+    /**
+     * @brief Calculates the height of the terrain at a certain position.
+     * @param position The position on the XZ plane.
+     * @return The height of the terrain.
+     */
+    float getHeight(const vec2& position);
+
+    /**
+     * @brief Calculates the normal of the terrain at a certain position.
+     * @param position The position on the XZ plane.
+     * @param epsilon The distance between the samples used to calculate the normal.
+     * @return The normal of the terrain.
+     */
+    vec3 getNormal(const vec2& position, float epsilon);
+
+    /**
+     * @brief Getter for the lowest height the terrain can reach.
+     * @return The minimum height of the terrain.
+     */
+    float getMinHeight();
+
+    /**
+     * @brief Getter for the highest height the terrain can reach.
+     * @return The maximum height of the terrain.
+     */
+    float getMaxHeight();
+
+    /**
+     * @brief Calculates the weight of each of the terrain's textures at a certain height.
+     * @param height The height of the terrain.
+     * @return The weights of the grass, dark grass, rock and snow textures, in that order.
+     */
+    vec4 getSplatWeights(float height);
+}
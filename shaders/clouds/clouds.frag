@@ -5,10 +5,25 @@
 
 #version 420 core
 
-in vec3 cameraPos; // Position de la caméra dans l'espace 3D
+#include "../common/camera.glsl"
+
+in vec3 cloudsCameraPos; // Position de la caméra dans l'espace 3D
 
 out vec4 fragColor; // Couleur finale du fragment
 
+// Paramètres de qualité, définis par les niveaux de qualité de l'application
+#ifndef CLOUD_STEPS
+#define CLOUD_STEPS 1000 // Nombre de pas de la marche dans les nuages
+#endif
+
+#ifndef CLOUD_OCTAVES
+#define CLOUD_OCTAVES 4 // Nombre de niveaux du bruit fractal
+#endif
+
+#ifndef VORONOI_RANGE
+#define VORONOI_RANGE 1 // Nombre de cellules voisines parcourues de chaque côté par Voronoi
+#endif
+
 // Paramètres de couleur et de lumière
 vec3 skytop = vec3(0.1, 0.5, 0.9); // Couleur du ciel en haut
 vec3 light = normalize(vec3(0.1, 0.2, 0.9)); // Direction de la lumière
@@ -16,13 +31,8 @@ vec2 cloudrange = vec2(1000.0, -1000.0); // Plage de hauteur des nuages
 vec3 cloudHeight = vec3(0.0, -10000.0, 0.0); // Position de base des nuages
 // Matrice pour la transformation des coordonnées des nuages
 mat3 m = mat3(0.00, 1.60, 1.20, -1.60, 0.72, -0.96, -1.20, -0.96, 1.28);
-
-// Uniformes 
-uniform vec2 resolution; // Résolution de l'écran
-uniform vec3 cameraFront; // Vecteur de direction de la caméra
-uniform vec3 cameraRight; // Vecteur de droite de la caméra
-uniform vec3 cameraUp; // Vecteur vers le haut de la caméra
-uniform float time; // Temps pour l'animation des nuages
+// Poids de chaque niveau du bruit fractal
+const float fbmWeights[4] = float[](0.5000, 0.2500, 0.1666, 0.0834);
 
 // Définition des types de nuages
 struct CloudType {
@@ -65,14 +75,14 @@ float noise(in vec3 x) {
 
 // Fonction de bruit fractal
 float fbm(vec3 p) {
-    float f = 0.5000 * noise(p); // Premier niveau de bruit
-    p = m * p; // Transformation avec la matrice
-    f += 0.2500 * noise(p); // Deuxième niveau de bruit
-    p = m * p; // Nouvelle transformation
-    f += 0.1666 * noise(p); // Troisième niveau de bruit
-    p = m * p; // Nouvelle transformation
-    f += 0.0834 * noise(p); // Quatrième niveau de bruit
-    return f; // Retourne le bruit fractal
+    float f = 0.0;
+    float total = 0.0;
+    for (int i = 0; i < CLOUD_OCTAVES; i++) {
+        f += fbmWeights[i] * noise(p); // Niveau de bruit
+        total += fbmWeights[i];
+        p = m * p; // Transformation avec la matrice
+    }
+    return f / total; // Retourne le bruit fractal, normalisé si des niveaux sont omis
 }
 
 // Fonction de Voronoi pour générer des motifs
@@ -82,9 +92,9 @@ float Voronoi(vec3 x, float scale) {
 
     float Distance = 100.0; // Distance maximale initiale
     // Boucle à travers les voisins
-    for (int k = -1; k <= 1; k++) {
-        for (int j = -1; j <= 1; j++) {
-            for (int i = -1; i <= 1; i++) {
+    for (int k = -VORONOI_RANGE; k <= VORONOI_RANGE; k++) {
+        for (int j = -VORONOI_RANGE; j <= VORONOI_RANGE; j++) {
+            for (int i = -VORONOI_RANGE; i <= VORONOI_RANGE; i++) {
                 vec3 b = vec3(float(i), float(j), float(k)); // Vecteur de décalage
                 vec3 r = vec3(b) - f + Hash(p + b); // Calcul de la position relative
                 float d = dot(r, r); // Calcul de la distance au carré
@@ -103,11 +113,12 @@ float Voronoi(vec3 x, float scale) {
 vec4 cloud(vec4 sum, float densiteMin, float densiteMax, vec3 externColor, vec3 internColor, vec3 direction) {
     vec3 position; // Position dans l'espace 3D
     float alpha, density; // Variables pour alpha et densité
-    float stepSize = 100.0; // Taille du pas pour le calcul des nuages
+    float stepSize = 100000.0 / float(CLOUD_STEPS); // Taille du pas pour le calcul des nuages
 
     // Boucle pour traverser la profondeur
-    for (float depth = 0.0; depth < 100000.0; depth += stepSize) {
-        position = cameraPos + direction * depth + cloudHeight + vec3(time * 100.0, 0.0, 0.0); // Calcul de la position du nuage
+    for (int i = 0; i < CLOUD_STEPS; i++) {
+        float depth = float(i) * stepSize; // Profondeur du pas
+        position = cloudsCameraPos + direction * depth + cloudHeight + vec3(time * 100.0, 0.0, 0.0); // Calcul de la position du nuage
 
         // Vérifie si la position est dans la plage de hauteur des nuages
         if (cloudrange.x > position.y && position.y > cloudrange.y) {
@@ -116,6 +127,7 @@ vec4 cloud(vec4 sum, float densiteMin, float densiteMax, vec3 externColor, vec3
             alpha = smoothstep(densiteMin, densiteMax, density); // Interpolation de l'alpha
 
             vec3 localcolor = mix(externColor, internColor, alpha); // Couleur locale basée sur l'alpha
+            alpha = 1.0 - pow(1.0 - alpha, stepSize / 100.0); // Opacité du pas, identique pour toutes les tailles de pas
 
             alpha *= (1.0 - sum.a); // Applique la transparence
             sum += vec4(localcolor * alpha, alpha); // Ajoute la couleur au résultat total
@@ -158,9 +170,7 @@ CloudType getActiveCloudType(float time) {
 }
 
 void main() {
-    vec2 uv = (2.0 * gl_FragCoord.xy - resolution) / resolution.y; // Calcul des coordonnées UV normalisées
-    float focalLength = 2.5f; // Longueur focale pour la caméra
-    vec3 direction = mat3(cameraRight, cameraUp, cameraFront) * normalize(vec3(uv, focalLength)); // Direction de la caméra
+    vec3 direction = getRayDirection(); // Direction de la caméra
 
     vec4 sum = vec4(0.0); // Initialisation de la somme des couleurs
     CloudType activeCloud = getActiveCloudType(time); // Obtient le type de nuage actif
@@ -5,15 +5,15 @@
 
 #version 420 core
 
-out vec3 cameraPos;
+#include "../common/frame_data.glsl"
 
-uniform vec3 cameraPosition;
+out vec3 cloudsCameraPos;
 
 layout(location = 0) in vec3 aPos;
 
 void main() {
-    cameraPos = cameraPosition;
-    cameraPos.y *= 10.0f;
+    cloudsCameraPos = cameraPos;
+    cloudsCameraPos.y *= 10.0f;
 
     gl_Position = vec4(aPos, 1.0f);
 }
\ No newline at end of file
@@ -0,0 +1,14 @@
+/***************************************************************************************************
+ * @file  camera.glsl
+ * @brief Camera rays of the full screen passes
+ **************************************************************************************************/
+
+#include "frame_data.glsl"
+
+const float FOCAL_LENGTH = 2.5f;
+
+// Direction of the camera ray going through the current fragment
+vec3 getRayDirection() {
+    vec2 uv = (2.0f * gl_FragCoord.xy - resolution) / resolution.y;
+    return mat3(cameraRight, cameraUp, cameraFront) * normalize(vec3(uv, FOCAL_LENGTH));
+}
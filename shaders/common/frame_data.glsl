@@ -0,0 +1,16 @@
+/***************************************************************************************************
+ * @file  frame_data.glsl
+ * @brief Uniform block shared by every shader program and written once per frame
+ **************************************************************************************************/
+
+// Mirrors FrameData in include/FrameData.hpp, any change must be reflected there
+layout(std140, binding = 0) uniform FrameData {
+    mat4 vpMatrix;       // View/projection matrix
+    vec3 cameraPos;      // Position of the camera
+    float time;          // Time since the start in seconds
+    vec3 cameraFront;    // Direction of the camera
+    vec3 cameraRight;    // Right vector of the camera
+    vec3 cameraUp;       // Up vector of the camera
+    vec3 lightDirection; // Direction of the sun light
+    vec2 resolution;     // Resolution of the window
+};
@@ -0,0 +1,32 @@
+/***************************************************************************************************
+ * @file  noise.glsl
+ * @brief 2D value noise shared by the terrain and the water made with noise
+ **************************************************************************************************/
+
+float fade(in float x) {
+    float x3 = x * x * x;
+    return 6.0f * x3 * x * x - 15.0f * x3 * x + 10.0f * x3;
+}
+
+float smoothLerp(in float a, in float b, in float t) {
+    return a + fade(t) * (b - a);
+}
+
+float rand2D(in vec2 co) {
+    return fract(sin(dot(co, vec2(12.9898f, 78.233f))) * 43758.5453f);
+}
+
+float perlinNoise(in vec2 pos) {
+    vec2 floorPos = floor(pos);
+    vec2 fractPos = fract(pos);
+
+    float g00 = rand2D(vec2(floorPos.x, floorPos.y));
+    float g01 = rand2D(vec2(floorPos.x, floorPos.y + 1.0f));
+    float g10 = rand2D(vec2(floorPos.x + 1.0f, floorPos.y));
+    float g11 = rand2D(vec2(floorPos.x + 1.0f, floorPos.y + 1.0f));
+
+    float nx = smoothLerp(g00, g10, fractPos.x);
+    float ny = smoothLerp(g01, g11, fractPos.x);
+
+    return smoothLerp(nx, ny, fractPos.y);
+}
@@ -5,6 +5,8 @@
 
 #version 420 core
 
+#include "../common/frame_data.glsl"
+
 in vec3 position;
 in vec3 normal;
 
@@ -13,9 +15,6 @@ in float maxHeight;
 
 out vec4 fragColor;
 
-uniform vec3 lightDirection;
-uniform vec3 cameraPos;
-
 float phongLighting() {
     /* Ambient */
     float ambient = 0.1f;
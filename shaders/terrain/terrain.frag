@@ -5,6 +5,8 @@
 
 #version 420 core
 
+#include "../common/frame_data.glsl"
+
 in vec3 position;
 in vec3 normal;
 in vec2 texCoords;
@@ -14,9 +16,6 @@ in float maxHeight;
 
 out vec4 fragColor;
 
-uniform vec3 cameraPos;
-uniform vec3 lightDirection;
-
 uniform float totalTerrainWidth;
 
 uniform sampler2D texRock;
@@ -6,10 +6,10 @@
 #version 420 core
 
 layout(location = 0) in vec3 aPos;
+layout(location = 4) in vec2 aChunk;
 
-uniform vec2 cameraChunk;
 uniform float chunkSize;
 
 void main() {
-    gl_Position.xzyw = vec4(aPos.xz + chunkSize * cameraChunk, 0.0f, 1.0f);
+    gl_Position.xzyw = vec4(aChunk + chunkSize * aPos.xz, 0.0f, 1.0f);
 }
\ No newline at end of file
@@ -0,0 +1,41 @@
+/***************************************************************************************************
+ * @file  vegetation.frag
+ * @brief Fragment shader for rendering the instanced grass and rocks
+ **************************************************************************************************/
+
+#version 420 core
+
+#include "../common/frame_data.glsl"
+
+in vec3 position;
+in vec3 normal;
+in float shade;
+
+out vec4 fragColor;
+
+uniform vec3 baseColor;
+
+uniform float totalTerrainWidth;
+
+float phongLighting() {
+    /* Ambient */
+    float ambient = 0.4f;
+
+    /* Diffuse */
+    vec3 lightDir = normalize(lightDirection);
+    float diffuse = max(dot(normalize(normal), lightDir), 0.0f);
+
+    return ambient + diffuse;
+}
+
+float fogFactor(float minDistance, float maxDistance) {
+    float dist = distance(position.xz, cameraPos.xz);
+    float fogFactor = (maxDistance - dist) / (maxDistance - minDistance);
+
+    return clamp(exp(fogFactor), 0.0f, 1.0f);
+}
+
+void main() {
+    fragColor.rgb = phongLighting() * shade * baseColor;
+    fragColor.a = fogFactor(totalTerrainWidth * 0.6f, totalTerrainWidth * 0.7f);
+}
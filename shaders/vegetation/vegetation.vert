@@ -0,0 +1,48 @@
+/***************************************************************************************************
+ * @file  vegetation.vert
+ * @brief Vertex shader for rendering the instanced grass and rocks
+ **************************************************************************************************/
+
+#version 420 core
+
+#include "../common/frame_data.glsl"
+
+layout(location = 0) in vec3 aPos;
+layout(location = 1) in vec3 aNormal;
+
+/* Per-instance attributes */
+layout(location = 4) in float instanceX;
+layout(location = 5) in float instanceZ;
+layout(location = 6) in float instanceY;
+layout(location = 7) in float instanceScale;
+
+out vec3 position;
+out vec3 normal;
+out float shade;
+
+uniform vec2 tileOrigin;
+uniform float tileSize;
+
+uniform vec2 scaleRange;
+uniform vec3 stretch;
+
+float rand2D(in vec2 co) {
+    return fract(sin(dot(co, vec2(12.9898f, 78.233f))) * 43758.5453f);
+}
+
+void main() {
+    vec3 origin = vec3(tileOrigin.x + instanceX * tileSize, instanceY, tileOrigin.y + instanceZ * tileSize);
+
+    float angle = 6.2831853f * rand2D(origin.xz);
+    mat2 rotation = mat2(cos(angle), sin(angle), -sin(angle), cos(angle));
+
+    vec3 local = aPos * stretch * mix(scaleRange.x, scaleRange.y, instanceScale);
+    local.xz = rotation * local.xz;
+
+    position = origin + local;
+    normal = aNormal;
+    normal.xz = rotation * normal.xz;
+    shade = mix(0.6f, 1.0f, clamp(aPos.y, 0.0f, 1.0f)) * mix(0.8f, 1.2f, rand2D(origin.zx));
+
+    gl_Position = vpMatrix * vec4(position, 1.0f);
+}
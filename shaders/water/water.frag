@@ -5,19 +5,22 @@
 
 #version 420 core
 
+#include "../common/camera.glsl"
+
 out vec4 fragColor;
 
 #define alpha fragColor.a
 
-uniform vec3 cameraPos;
-uniform float time;
-uniform vec3 cameraFront;
-uniform vec3 cameraRight;
-uniform vec3 cameraUp;
-uniform vec2 resolution;
 uniform float maxDistance;
 
-const uint MAX_STEPS = 128;
+#ifndef MAX_STEPS
+#define MAX_STEPS 128u
+#endif
+
+#ifndef WAVE_OCTAVES
+#define WAVE_OCTAVES 12
+#endif
+
 const float MIN_DISTANCE = 0.001f;
 const float WATER_DEPTH = 3.0f;
 const float DRAG = 0.58f;
@@ -27,10 +30,6 @@ struct Ray {
     vec3 direction;
 };
 
-vec2 getUV() {
-    return (2.0f * gl_FragCoord.xy - resolution) / resolution.y;
-}
-
 vec2 wavedx(vec2 pos, vec2 dir, float freq, float timeShift) {
     float x = dot(dir, pos) * freq + timeShift;
     float wave = exp(sin(x) - 1.0f);
@@ -47,7 +46,7 @@ float getWaves(vec2 position) {
     float sumValues = 0.0f;
     float sumWeights = 0.0f;
 
-    for (int i = 0; i < 12; i++) {
+    for (int i = 0; i < WAVE_OCTAVES; i++) {
         vec2 wavedir = vec2(sin(iter * i), cos(iter * i));
         vec2 wave = wavedx(position, wavedir, freq, time * timeMult + waveShift);
 
@@ -99,9 +98,7 @@ float raymarch(in Ray ray) {
 }
 
 void main() {
-    vec2 uv = getUV();
-    float focalLength = 2.5f;
-    Ray ray = Ray(cameraPos, mat3(cameraRight, cameraUp, cameraFront) * normalize(vec3(uv, focalLength)));
+    Ray ray = Ray(cameraPos, getRayDirection());
 
     if (ray.direction.y >= 0) {
         discard;
@@ -5,9 +5,10 @@
 
 #version 420 core
 
+#include "../common/frame_data.glsl"
+
 layout(location = 0) in vec3 aPos;
 
-uniform mat4 vpMatrix;
 uniform float totalTerrainWidth;
 
 void main() {
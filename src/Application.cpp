@@ -11,20 +11,44 @@
 #include "backends/imgui_impl_glfw.h"
 #include "backends/imgui_impl_opengl3.h"
 #include "misc/cpp/imgui_stdlib.h"
+#include "Frustum.hpp"
+#include "mesh/MeshCache.hpp"
 #include "mesh/meshes.hpp"
+#include "terrain/height.hpp"
+
+namespace {
+    constexpr int captureChunks = 5;          ///< Side length of the grid of chunks captured around the camera.
+    constexpr unsigned int maxTessLevel = Quality::TIERS[Quality::HIGH].tessLevel; ///< The highest MAX_TESS_LEVEL of the tiers.
+}
 
 Application::Application()
     : window(this),
       time(0.0f), delta(0.0f),
       lightDirection(2.0f, 2.0f, 0.0f),
       wireframe(false), cullface(true), isCursorVisible(false),
-      sTerrain(nullptr), sWater(nullptr), sNWater(nullptr), sClouds(nullptr),
+      firstFrameTime(0.0f), shadersReadyTime(0.0f), texturesReadyTime(0.0f),
+      sTerrain(nullptr), sTerrainCapture(nullptr),
+      sWater(nullptr), sNWater(nullptr), sClouds(nullptr), sVegetation(nullptr),
+      shaderWatcher("shaders"), quality(Quality::HIGH),
       chunkSize(32.0f), chunks(128),
       projection(perspective(M_PI_4f, window.getRatio(), 0.1f, 2.0f * chunkSize * chunks)),
       camera(vec3(0.0f, 20.0f, 0.0f)), cameraPos(camera.getPositionReference()),
-      grid(Meshes::tessGrid(chunkSize * chunks, chunks)), screen(Meshes::screen()), plane(Meshes::plane(1.0f)),
-      texRock("data/rock.jpg"), texRockSmooth("data/rock_smooth.jpg"), texGrass("data/grass.jpg"),
-      texGrassDark("data/grass_dark.png"), texSnow("data/snow.png") {
+      chunk(Meshes::chunk()), screen(Meshes::screen()), plane(Meshes::plane(1.0f)),
+      dynamicData(2 * (chunks * chunks + captureChunks * captureChunks) * sizeof(float) + sizeof(FrameData) + 512),
+      uniformAlignment(256),
+      terrainCapture(captureChunks * captureChunks * 2 * maxTessLevel * maxTessLevel), captureRequested(false),
+      vegetation(chunkSize, 24),
+      texRock("data/rock.jpg", true), texRockSmooth("data/rock_smooth.jpg", true), texGrass("data/grass.jpg", true),
+      texGrassDark("data/grass_dark.png", true), texSnow("data/snow.png", true) {
+
+    /**** Meshes ****/
+    plane.setQuantized(true);
+
+    chunk.setRetention(Mesh::RELEASE);
+    chunk.setRegenerator([] { return Meshes::chunk(); });
+    visibleChunks.reserve(2 * chunks * chunks);
+    screen.setRetention(Mesh::RELEASE);
+    plane.setRetention(Mesh::RELEASE);
 
     /**** ImGui ****/
     IMGUI_CHECKVERSION();
@@ -41,40 +65,73 @@ Application::Application()
         "shaders/terrain/terrain.tese",
         "shaders/terrain/terrain.frag"
     };
-    sTerrain = new Shader(paths, 4, "Terrain");
+    const Shader::Defines qualityDefines = Quality::getDefines(quality);
+
+    // Built in the background, each program is used from the first frame it is ready
+    sTerrain = new Shader(paths, 4, "Terrain", {}, qualityDefines, true);
+    sTerrainCapture = new Shader(paths, 3, "Terrain Capture", {"position", "normal"}, qualityDefines, true);
 
     paths[2] = "shaders/noise_water/noise_water.tese";
     paths[3] = "shaders/noise_water/noise_water.frag";
-    sNWater = new Shader(paths, 4, "Noise Water");
+    sNWater = new Shader(paths, 4, "Noise Water", {}, qualityDefines, true);
 
     paths[0] = "shaders/water/water.vert";
     paths[1] = "shaders/water/water.frag";
-    sWater = new Shader(paths, 2, "Water");
+    sWater = new Shader(paths, 2, "Water", {}, qualityDefines, true);
 
     paths[0] = "shaders/clouds/clouds.vert";
     paths[1] = "shaders/clouds/clouds.frag";
-    sClouds = new Shader(paths, 2, "Clouds");
+    sClouds = new Shader(paths, 2, "Clouds", {}, qualityDefines, true);
 
-    /**** Textures ****/
-    sTerrain->use();
+    paths[0] = "shaders/vegetation/vegetation.vert";
+    paths[1] = "shaders/vegetation/vegetation.frag";
+    sVegetation = new Shader(paths, 2, "Vegetation", {}, {}, true);
+
+    /**** Uniforms ****/
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &uniformAlignment);
 
-    sTerrain->setUniform("texRock", 0);
+    // Values that never change, the others are in the FrameData uniform block
+    auto setTerrainConstants = [this](Shader& shader) {
+        shader.getUniformHandle<float>("chunkSize").set(chunkSize);
+        shader.getUniformHandle<float>("totalTerrainWidth").set(chunks * chunkSize / 2.0f);
+    };
+
+    shaders = {
+        {sTerrain, [this, setTerrainConstants](Shader& shader) {
+            setTerrainConstants(shader);
+            shader.getUniformHandle<int>("texRock").set(0);
+            shader.getUniformHandle<int>("texRockSmooth").set(1);
+            shader.getUniformHandle<int>("texGrass").set(2);
+            shader.getUniformHandle<int>("texGrassDark").set(3);
+            shader.getUniformHandle<int>("texSnow").set(4);
+        }},
+        {sTerrainCapture, setTerrainConstants},
+        {sNWater, setTerrainConstants},
+        {sWater, [this](Shader& shader) {
+            shader.getUniformHandle<float>("totalTerrainWidth").set(chunks * chunkSize);
+            shader.getUniformHandle<float>("maxDistance").set(chunks * chunkSize / 2.0f);
+        }},
+        {sClouds, [](Shader&) { }},
+        {sVegetation, [this](Shader& shader) {
+            shader.getUniformHandle<float>("totalTerrainWidth").set(chunks * chunkSize / 2.0f);
+        }}
+    };
+
+    /**** Textures ****/
     texRock.bind(0);
-    sTerrain->setUniform("texRockSmooth", 1);
     texRockSmooth.bind(1);
-    sTerrain->setUniform("texGrass", 2);
     texGrass.bind(2);
-    sTerrain->setUniform("texGrassDark", 3);
     texGrassDark.bind(3);
-    sTerrain->setUniform("texSnow", 4);
     texSnow.bind(4);
 }
 
 Application::~Application() {
     delete sTerrain;
+    delete sTerrainCapture;
     delete sWater;
     delete sNWater;
     delete sClouds;
+    delete sVegetation;
 
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplGlfw_Shutdown();
@@ -87,38 +144,109 @@ void Application::run() {
         ImGui_ImplGlfw_NewFrame();
         ImGui::NewFrame();
 
+        dynamicData.beginFrame();
+        terrainCapture.poll();
+        Shader::resetCounts();
+        updateShaders();
+        updateTextures();
+
         handleEvents();
         updateVariables();
+        updateFrameData();
 
         glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
         /**** Background & Clouds ****/
-        sClouds->use();
-        updateCloudsUniforms();
-        drawClouds();
+        if(sClouds->isReady()) {
+            sClouds->use();
+            drawClouds();
+        }
 
         /**** Terrain ****/
-        sTerrain->use();
-        updateTerrainUniforms();
-        grid.draw();
+        if(sTerrain->isReady()) {
+            sTerrain->use();
+            drawTerrain();
+        }
+
+        if(captureRequested && sTerrainCapture->isReady()) {
+            sTerrainCapture->use();
+            captureTerrain();
+            captureRequested = false;
+        }
+
+        /**** Vegetation ****/
+        if(sVegetation->isReady()) {
+            sVegetation->use();
+            vegetation.draw(*sVegetation, vpMatrix, cameraPos);
+        }
 
 //        /**** Noise Water ****/
 //        sNWater->use();
-//        updateNoiseWaterUniforms();
-//        grid.draw();
+//        chunk.drawInstanced();
 
         /**** Water ****/
-        sWater->use();
-        updateWaterUniforms();
-        drawWater();
+        if(sWater->isReady()) {
+            sWater->use();
+            drawWater();
+        }
 
         /**** Debug ImGui Window ****/
         debugWindow();
 
         ImGui::Render();
         ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+
+        dynamicData.endFrame();
         glfwSwapBuffers(window);
+
+        if(firstFrameTime == 0.0f) {
+            firstFrameTime = 1000.0f * glfwGetTime();
+        }
+    }
+}
+
+void Application::updateShaders() {
+    const std::vector<std::string> changedFiles = shaderWatcher.poll();
+
+    bool ready = true;
+    for(const auto& [shader, setUniforms]: shaders) {
+        for(const std::string& file: changedFiles) {
+            if(shader->dependsOn(file)) {
+                shader->reload();
+                break;
+            }
+        }
+
+        if(shader->poll()) {
+            setUniforms(*shader);
+        }
+
+        ready = ready && shader->isReady();
+    }
+
+    if(ready && shadersReadyTime == 0.0f) {
+        shadersReadyTime = 1000.0f * glfwGetTime();
+    }
+}
+
+void Application::updateTextures() {
+    bool ready = true;
+    for(Texture* texture: {&texRock, &texRockSmooth, &texGrass, &texGrassDark, &texSnow}) {
+        ready = texture->poll() && ready;
+    }
+
+    if(ready && texturesReadyTime == 0.0f) {
+        texturesReadyTime = 1000.0f * glfwGetTime();
+    }
+}
+
+void Application::setQuality(Quality::Tier tier) {
+    quality = tier;
+
+    const Shader::Defines defines = Quality::getDefines(tier);
+    for(Shader* shader: {sTerrain, sTerrainCapture, sNWater, sWater, sClouds}) {
+        shader->setDefines(defines);
     }
 }
 
@@ -166,6 +294,11 @@ void Application::handleKeyboardEvents() {
                     glPolygonMode(GL_FRONT_AND_BACK, wireframe ? GL_FILL : GL_LINE);
                     wireframe = !wireframe;
 
+                    keys[key] = false;
+                    break;
+                case GLFW_KEY_P:
+                    captureRequested = true;
+
                     keys[key] = false;
                     break;
                 case GLFW_KEY_C:
@@ -203,6 +336,23 @@ void Application::updateVariables() {
     vpMatrix = projection * camera.getViewMatrix();
     cameraChunk.x = floor(0.5f + cameraPos.x / chunkSize);
     cameraChunk.y = floor(0.5f + cameraPos.z / chunkSize);
+    vegetation.update(cameraPos);
+}
+
+void Application::updateFrameData() {
+    const FrameData frameData{
+        .vpMatrix = vpMatrix,
+        .cameraPos = cameraPos,
+        .time = time,
+        .cameraFront = camera.getDirection(),
+        .cameraRight = camera.getRight(),
+        .cameraUp = camera.getUp(),
+        .lightDirection = lightDirection,
+        .resolution = window.getResolution()
+    };
+
+    const unsigned int offset = dynamicData.write(&frameData, sizeof(FrameData), uniformAlignment);
+    glBindBufferRange(GL_UNIFORM_BUFFER, FrameData::BINDING, dynamicData.getBuffer(), offset, sizeof(FrameData));
 }
 
 void Application::debugWindow() {
@@ -212,16 +362,104 @@ void Application::debugWindow() {
     ImGui::Text("Position: (%.2f ; %.2f ; %.2f)", cameraPos.x, cameraPos.y, cameraPos.z);
     ImGui::Text("Chunk: (%.0f ; %.0f)", cameraChunk.x, cameraChunk.y);
     ImGui::InputFloat("Camera Speed", &camera.movementSpeed);
+    int tier = quality;
+    ImGui::Combo("Quality", &tier, [](void*, int i) { return Quality::TIERS[i].name; }, nullptr, std::size(Quality::TIERS));
+    if(tier != quality) {
+        setQuality(static_cast<Quality::Tier>(tier));
+    }
+    ImGui::Text("Vegetation: %u/%u instances drawn", vegetation.getDrawnInstances(), vegetation.getStoredInstances());
+    ImGui::Text("Vegetation: %u tiles | culling %.3fms", vegetation.getTileCount(), vegetation.getCullingTime());
+    if(vegetation.isRockCached()) {
+        ImGui::Text("Rock ACMR: loaded from cache");
+    } else {
+        ImGui::Text("Rock ACMR: %.3f -> %.3f", vegetation.getRockACMR().x, vegetation.getRockACMR().y);
+    }
+    for(unsigned int i = 0 ; i < vegetation.getRockLODs().size() ; ++i) {
+        const Mesh::LOD& lod = vegetation.getRockLODs()[i];
+        ImGui::Text("Rock LOD %u: %u triangles | error %.4f", i, lod.indexCount / 3, lod.error);
+    }
+    if(!vegetation.isRockCached()) {
+        ImGui::Text("Rock LODs: %.2fM triangles/s", vegetation.getLODThroughput() / 1e6f);
+    }
+    ImGui::Text("Shaders: %u programs in %.1fms | %u from cache", Shader::getProgramCount(),
+                Shader::getLoadTime(), Shader::getCachedProgramCount());
+    ImGui::Text("Startup: first frame at %.0fms | shaders at %.0fms | textures at %.0fms", firstFrameTime,
+                shadersReadyTime, texturesReadyTime);
+    ImGui::Text("Textures: %.1fms loading on worker threads", Texture::getLoadTime());
+    ImGui::Text("Texture cache: %u hits | %u misses", MipChain::getHits(), MipChain::getMisses());
+    ImGui::Text("Shader reload: %.1fms to swap", Shader::getReloadTime());
+    ImGui::Text("Uniforms: %u uploaded | %u skipped | %u program binds skipped", Shader::getUploadCount(),
+                Shader::getSkippedUploadCount(), Shader::getSkippedUseCount());
+    ImGui::Text("Mesh cache: %u hits | %u misses | %.1fms saved",
+                MeshCache::getHits(), MeshCache::getMisses(), MeshCache::getSavedTime());
+    ImGui::Text("Meshes: %u copies | %u VAOs and %u buffers created", Mesh::getCopyCount(),
+                VertexArray::getCreatedCount(), Buffer::getCreatedCount());
+    ImGui::Text("Terrain: %zu/%d chunks drawn", visibleChunks.size() / 2, chunks * chunks);
+    if(terrainCapture.isPending()) {
+        ImGui::Text("Terrain capture: pending");
+    } else if(terrainCapture.getTriangleCount() > 0) {
+        ImGui::Text("Terrain capture: %u triangles%s | GPU %.3fms | readback %.3fms",
+                    terrainCapture.getTriangleCount(), terrainCapture.isTruncated() ? " (truncated)" : "",
+                    terrainCapture.getGPUTime(), terrainCapture.getReadbackTime());
+        ImGui::Text("Terrain capture: height error %.4f mean | %.4f max",
+                    terrainCapture.getHeightError().x, terrainCapture.getHeightError().y);
+    } else {
+        ImGui::Text("Terrain capture: press P");
+    }
+    ImGui::Text("Dynamic buffer: %.1f%% used | %.3fms stalled%s", 100.0f * dynamicData.getOccupancy(),
+                dynamicData.getStallTime(), dynamicData.isPersistent() ? "" : " | not persistent");
+    ImGui::Text("Chunk: %.1fKiB on GPU | %.1fKiB saved", chunk.getGPUSize() / 1024.0f, chunk.getSavedGPUSize() / 1024.0f);
+    ImGui::Text("Screen: %.1fKiB on GPU | %.1fKiB saved", screen.getGPUSize() / 1024.0f, screen.getSavedGPUSize() / 1024.0f);
+    ImGui::Text("Plane: %.1fKiB on GPU | %.1fKiB saved", plane.getGPUSize() / 1024.0f, plane.getSavedGPUSize() / 1024.0f);
+    ImGui::Text("Meshes: %.1fKiB on CPU | %.1fKiB on GPU",
+                (chunk.getCPUSize() + screen.getCPUSize() + plane.getCPUSize() + vegetation.getMeshCPUSize()) / 1024.0f,
+                (chunk.getGPUSize() + screen.getGPUSize() + plane.getGPUSize() + vegetation.getMeshGPUSize()) / 1024.0f);
     ImGui::End();
 }
 
-void Application::updateTerrainUniforms() {
-    sTerrain->setUniform("vpMatrix", vpMatrix);
-    sTerrain->setUniform("cameraPos", cameraPos);
-    sTerrain->setUniform("cameraChunk", cameraChunk);
-    sTerrain->setUniform("chunkSize", chunkSize);
-    sTerrain->setUniform("totalTerrainWidth", chunks * chunkSize / 2.0f);
-    sTerrain->setUniform("lightDirection", lightDirection);
+void Application::drawTerrain() {
+    const Frustum frustum(vpMatrix);
+    const float low = Terrain::getMinHeight();
+    const float high = Terrain::getMaxHeight();
+
+    visibleChunks.clear();
+    for(int i = 0 ; i < chunks ; ++i) {
+        for(int j = 0 ; j < chunks ; ++j) {
+            const vec2 center = chunkSize * (cameraChunk + vec2(j - chunks / 2, i - chunks / 2) + vec2(0.5f));
+
+            if(frustum.intersects(vec3(center.x - chunkSize / 2.0f, low, center.y - chunkSize / 2.0f),
+                                  vec3(center.x + chunkSize / 2.0f, high, center.y + chunkSize / 2.0f))) {
+                visibleChunks.insert(visibleChunks.end(), {center.x, center.y});
+            }
+        }
+    }
+
+    // Center of each chunk on the XZ plane
+    const unsigned int offset = dynamicData.write(std::span<const float>(visibleChunks));
+    chunk.setInstanceAttribute(Mesh::FIRST_INSTANCE_LOCATION, dynamicData.getBuffer(), 2, GL_FLOAT, false, offset);
+    chunk.drawInstanced(visibleChunks.size() / 2);
+}
+
+void Application::captureTerrain() {
+    if(!terrainCapture.begin()) {
+        return;
+    }
+
+    // Every chunk around the camera, visible or not, so that the capture can be used for collisions
+    std::vector<float> centers;
+    centers.reserve(2 * captureChunks * captureChunks);
+    for(int i = 0 ; i < captureChunks ; ++i) {
+        for(int j = 0 ; j < captureChunks ; ++j) {
+            const vec2 center = chunkSize * (cameraChunk + vec2(j - captureChunks / 2, i - captureChunks / 2) + vec2(0.5f));
+            centers.insert(centers.end(), {center.x, center.y});
+        }
+    }
+
+    const unsigned int offset = dynamicData.write(std::span<const float>(centers));
+    chunk.setInstanceAttribute(Mesh::FIRST_INSTANCE_LOCATION, dynamicData.getBuffer(), 2, GL_FLOAT, false, offset);
+    chunk.drawInstanced(captureChunks * captureChunks);
+
+    terrainCapture.end();
 }
 
 void Application::drawWater() {
@@ -232,28 +470,6 @@ void Application::drawWater() {
     if(wireframe) { glPolygonMode(GL_FRONT_AND_BACK, GL_LINE); }
 }
 
-void Application::updateNoiseWaterUniforms() {
-    sNWater->setUniform("vpMatrix", vpMatrix);
-    sNWater->setUniform("cameraPos", cameraPos);
-    sNWater->setUniform("cameraChunk", cameraChunk);
-    sNWater->setUniform("chunkSize", chunkSize);
-    sNWater->setUniform("totalTerrainWidth", chunks * chunkSize / 2.0f);
-    sNWater->setUniform("lightDirection", lightDirection);
-    sNWater->setUniform("time", time);
-}
-
-void Application::updateWaterUniforms() {
-    sWater->setUniform("vpMatrix", vpMatrix);
-    sWater->setUniform("resolution", window.getResolution());
-    sWater->setUniform("cameraPos", cameraPos);
-    sWater->setUniform("cameraFront", camera.getDirection());
-    sWater->setUniform("cameraRight", camera.getRight());
-    sWater->setUniform("cameraUp", camera.getUp());
-    sWater->setUniform("totalTerrainWidth", chunks * chunkSize);
-    sWater->setUniform("time", time);
-    sWater->setUniform("maxDistance", chunks * chunkSize / 2.0f);
-}
-
 void Application::drawClouds() {
     glDepthMask(GL_FALSE);
     glDisable(GL_DEPTH_TEST);
@@ -265,12 +481,3 @@ void Application::drawClouds() {
     glEnable(GL_DEPTH_TEST);
     glDepthMask(GL_TRUE);
 }
-
-void Application::updateCloudsUniforms() {
-    sClouds->setUniform("resolution", window.getResolution());
-    sClouds->setUniform("cameraPosition", cameraPos);
-    sClouds->setUniform("cameraFront", camera.getDirection());
-    sClouds->setUniform("cameraRight", camera.getRight());
-    sClouds->setUniform("cameraUp", camera.getUp());
-    sClouds->setUniform("time", time);
-}
@@ -0,0 +1,80 @@
+/***************************************************************************************************
+ * @file  FileWatcher.cpp
+ * @brief Implementation of the FileWatcher class
+ **************************************************************************************************/
+
+#include "FileWatcher.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+FileWatcher::FileWatcher(const std::string& directory)
+    : descriptor(inotify_init1(IN_NONBLOCK | IN_CLOEXEC)) {
+
+    if(descriptor == -1) {
+        std::cout << "Failed to initialize inotify, " << directory << " won't be reloaded.\n";
+        return;
+    }
+
+    watch(directory);
+}
+
+FileWatcher::~FileWatcher() {
+    if(descriptor != -1) {
+        close(descriptor);
+    }
+}
+
+std::vector<std::string> FileWatcher::poll() {
+    std::vector<std::string> files;
+    if(descriptor == -1) {
+        return files;
+    }
+
+    alignas(inotify_event) char buffer[4096];
+    ssize_t length;
+    while((length = read(descriptor, buffer, sizeof(buffer))) > 0) {
+        for(char* event = buffer ; event < buffer + length ; ) {
+            const inotify_event* notification = reinterpret_cast<const inotify_event*>(event);
+            event += sizeof(inotify_event) + notification->len;
+
+            const auto directory = directories.find(notification->wd);
+            if(notification->len == 0 || directory == directories.end()) {
+                continue;
+            }
+
+            const std::string path = std::filesystem::path(directory->second + '/' + notification->name)
+                                     .lexically_normal().string();
+
+            // A created file is only read once it is closed
+            if(notification->mask & IN_ISDIR) {
+                watch(path);
+            } else if(!(notification->mask & IN_CREATE) && std::find(files.begin(), files.end(), path) == files.end()) {
+                files.push_back(path);
+            }
+        }
+    }
+
+    return files;
+}
+
+void FileWatcher::watch(const std::string& directory) {
+    // Editors either write files in place or write a new file and move it over the old one
+    const int id = inotify_add_watch(descriptor, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+    if(id == -1) {
+        std::cout << "Failed to watch " << directory << ", its files won't be reloaded.\n";
+        return;
+    }
+
+    directories[id] = directory;
+
+    std::error_code error;
+    for(const auto& entry: std::filesystem::directory_iterator(directory, error)) {
+        if(entry.is_directory()) {
+            watch(entry.path().lexically_normal().string());
+        }
+    }
+}
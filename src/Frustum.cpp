@@ -0,0 +1,49 @@
+/***************************************************************************************************
+ * @file  Frustum.cpp
+ * @brief Implementation of the Frustum class
+ **************************************************************************************************/
+
+#include "Frustum.hpp"
+
+#include <cmath>
+
+Frustum::Frustum(const mat4& vpMatrix) {
+    vec4 rows[4];
+    for(int i = 0 ; i < 4 ; ++i) {
+        rows[i] = vec4(vpMatrix[0][i], vpMatrix[1][i], vpMatrix[2][i], vpMatrix[3][i]);
+    }
+
+    planes[0] = rows[3] + rows[0];
+    planes[1] = rows[3] - rows[0];
+    planes[2] = rows[3] + rows[1];
+    planes[3] = rows[3] - rows[1];
+    planes[4] = rows[3] + rows[2];
+    planes[5] = rows[3] - rows[2];
+}
+
+bool Frustum::intersects(const vec3& low, const vec3& high) const {
+    for(const vec4& plane: planes) {
+        // Corner of the box the furthest along the plane's normal
+        const vec3 corner(plane.x > 0.0f ? high.x : low.x,
+                          plane.y > 0.0f ? high.y : low.y,
+                          plane.z > 0.0f ? high.z : low.z);
+
+        if(plane.x * corner.x + plane.y * corner.y + plane.z * corner.z + plane.w < 0.0f) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool Frustum::intersects(const vec3& center, float radius) const {
+    for(const vec4& plane: planes) {
+        const float length = std::sqrt(plane.x * plane.x + plane.y * plane.y + plane.z * plane.z);
+
+        if(plane.x * center.x + plane.y * center.y + plane.z * center.z + plane.w < -radius * length) {
+            return false;
+        }
+    }
+
+    return true;
+}
@@ -14,6 +14,15 @@ Image::Image(const std::string& path) {
     nbChannels = nbC;
 }
 
+Image::Image(const unsigned char* buffer, unsigned int size) {
+    int W, H, nbC;
+    data = stbi_load_from_memory(buffer, size, &W, &H, &nbC, 3);
+
+    width = W;
+    height = H;
+    nbChannels = nbC;
+}
+
 Image::~Image() {
     stbi_image_free(data);
 }
@@ -0,0 +1,293 @@
+/***************************************************************************************************
+ * @file  MipChain.cpp
+ * @brief Implementation of the MipChain class
+ **************************************************************************************************/
+
+#include "MipChain.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+    constexpr char directory[] = "cache/textures/"; ///< Where the cached mip chains are stored.
+    constexpr uint32_t version = 1;                 ///< Incremented whenever the format changes.
+    constexpr size_t alignment = 16;                ///< Alignment of the level blobs in the file.
+
+    /**
+     * @struct Header
+     * @brief Beginning of a cached mip chain file. The table of the levels directly follows it.
+     */
+    struct Header {
+        char magic[4];       ///< Always "MIPS".
+        uint32_t version;    ///< The version of the format.
+        uint32_t levelCount; ///< The amount of levels.
+        uint32_t padding;    ///< Unused.
+        uint64_t sourceSize; ///< The size of the image file the levels come from.
+        int64_t sourceTime;  ///< The last modification time of the image file the levels come from.
+    };
+
+    /**
+     * @struct LevelEntry
+     * @brief Describes a level in the file.
+     */
+    struct LevelEntry {
+        uint32_t width;  ///< The width of the level.
+        uint32_t height; ///< The height of the level.
+        uint64_t offset; ///< The position of the level blob in the file.
+    };
+
+    static_assert(std::is_trivially_copyable_v<Header>);
+    static_assert(std::is_trivially_copyable_v<LevelEntry>);
+
+    size_t align(size_t offset) {
+        return (offset + alignment - 1) / alignment * alignment;
+    }
+
+    /**
+     * @brief Converts an sRGB encoded value to linear space, through a table.
+     * @param value The encoded value.
+     * @return The linear value between 0 and 1.
+     */
+    float toLinear(unsigned char value) {
+        static const std::array<float, 256> table = [] {
+            std::array<float, 256> table;
+            for(unsigned int i = 0 ; i < 256 ; ++i) {
+                const float x = i / 255.0f;
+                table[i] = x <= 0.04045f ? x / 12.92f : std::pow((x + 0.055f) / 1.055f, 2.4f);
+            }
+
+            return table;
+        }();
+
+        return table[value];
+    }
+
+    /**
+     * @brief Converts a linear value to sRGB.
+     * @param value The linear value between 0 and 1.
+     * @return The encoded value.
+     */
+    unsigned char toSRGB(float value) {
+        const float x = value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+        return static_cast<unsigned char>(std::clamp(x, 0.0f, 1.0f) * 255.0f + 0.5f);
+    }
+}
+
+std::atomic<unsigned int> MipChain::hits = 0;
+std::atomic<unsigned int> MipChain::misses = 0;
+
+std::unique_ptr<MipChain> MipChain::get(const std::string& path) {
+    std::error_code error;
+    const uint64_t sourceSize = std::filesystem::file_size(path, error);
+    const int64_t sourceTime = std::filesystem::last_write_time(path, error).time_since_epoch().count();
+    if(error) {
+        throw std::runtime_error("Failed to open texture file " + path + ".");
+    }
+
+    std::string name = path;
+    std::replace(name.begin(), name.end(), '/', '_');
+    const std::string cachePath = directory + name + ".mips";
+
+    std::unique_ptr<MipChain> cached = load(cachePath, sourceSize, sourceTime);
+    if(cached) {
+        ++hits;
+        return cached;
+    }
+
+    std::ifstream file(path, std::ios::binary);
+    const std::vector<unsigned char> content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    const Image image(content.data(), content.size());
+    if(!image.getData()) {
+        throw std::runtime_error("Failed to decode texture file " + path + ": " + stbi_failure_reason());
+    }
+
+    auto chain = std::make_unique<MipChain>(image);
+    ++misses;
+
+    // The cache only speeds up the next startups, the levels are usable even if they can't be stored
+    try {
+        std::filesystem::create_directories(directory, error);
+        chain->save(cachePath, sourceSize, sourceTime);
+    } catch(const std::exception&) { }
+
+    return chain;
+}
+
+MipChain::MipChain() : mapping(nullptr), mappingSize(0) { }
+
+MipChain::MipChain(const Image& image) : mapping(nullptr), mappingSize(0) {
+    /**** Layout ****/
+    std::vector<size_t> offsets;
+    unsigned int width = image.getWidth();
+    unsigned int height = image.getHeight();
+    size_t size = 0;
+
+    while(true) {
+        offsets.push_back(size);
+        levels.push_back({width, height, nullptr});
+        size = align(size + static_cast<size_t>(width) * height * 3);
+
+        if(width == 1 && height == 1) {
+            break;
+        }
+
+        width = std::max(width / 2, 1u);
+        height = std::max(height / 2, 1u);
+    }
+
+    storage.resize(size);
+    for(unsigned int i = 0 ; i < levels.size() ; ++i) {
+        levels[i].data = storage.data() + offsets[i];
+    }
+
+    /**** Downsampling ****/
+    std::memcpy(storage.data(), image.getData(), static_cast<size_t>(image.getWidth()) * image.getHeight() * 3);
+
+    // Each level is averaged from the linear values of the previous one, so that the rounding of
+    // the stored levels doesn't accumulate
+    std::vector<float> previous(static_cast<size_t>(image.getWidth()) * image.getHeight() * 3);
+    std::transform(image.getData(), image.getData() + previous.size(), previous.begin(), toLinear);
+
+    std::vector<float> current;
+    for(unsigned int i = 1 ; i < levels.size() ; ++i) {
+        const Level& source = levels[i - 1];
+        const Level& level = levels[i];
+        unsigned char* texels = storage.data() + offsets[i];
+
+        current.resize(static_cast<size_t>(level.width) * level.height * 3);
+
+        for(unsigned int y = 0 ; y < level.height ; ++y) {
+            // Odd sizes repeat the last row or column
+            const float* row0 = previous.data() + static_cast<size_t>(std::min(2 * y, source.height - 1)) * source.width * 3;
+            const float* row1 = previous.data() + static_cast<size_t>(std::min(2 * y + 1, source.height - 1)) * source.width * 3;
+            float* destination = current.data() + static_cast<size_t>(y) * level.width * 3;
+
+            for(unsigned int x = 0 ; x < level.width ; ++x) {
+                const unsigned int x0 = std::min(2 * x, source.width - 1) * 3;
+                const unsigned int x1 = std::min(2 * x + 1, source.width - 1) * 3;
+
+                for(unsigned int c = 0 ; c < 3 ; ++c) {
+                    destination[x * 3 + c] = 0.25f * (row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c]);
+                }
+            }
+        }
+
+        std::transform(current.begin(), current.end(), texels, toSRGB);
+        previous.swap(current);
+    }
+}
+
+MipChain::~MipChain() {
+    if(mapping) {
+        munmap(mapping, mappingSize);
+    }
+}
+
+void MipChain::save(const std::string& path, uint64_t sourceSize, int64_t sourceTime) const {
+    Header header{};
+    std::memcpy(header.magic, "MIPS", 4);
+    header.version = version;
+    header.levelCount = levels.size();
+    header.sourceSize = sourceSize;
+    header.sourceTime = sourceTime;
+
+    std::vector<LevelEntry> entries;
+    size_t offset = align(sizeof(Header) + levels.size() * sizeof(LevelEntry));
+    for(const Level& level: levels) {
+        entries.push_back({level.width, level.height, offset});
+        offset = align(offset + static_cast<size_t>(level.width) * level.height * 3);
+    }
+
+    std::vector<unsigned char> file(offset, 0);
+    std::memcpy(file.data(), &header, sizeof(Header));
+    std::memcpy(file.data() + sizeof(Header), entries.data(), entries.size() * sizeof(LevelEntry));
+    for(unsigned int i = 0 ; i < levels.size() ; ++i) {
+        std::memcpy(file.data() + entries[i].offset, levels[i].data, static_cast<size_t>(levels[i].width) * levels[i].height * 3);
+    }
+
+    // Written next to the destination then renamed so that a partial file is never loaded
+    const std::string temporary = path + ".tmp";
+    std::ofstream stream(temporary, std::ios::binary | std::ios::trunc);
+    stream.write(reinterpret_cast<const char*>(file.data()), file.size());
+    stream.close();
+
+    if(!stream) {
+        throw std::runtime_error("Failed to write the cached mip chain " + path + ".");
+    }
+
+    std::filesystem::rename(temporary, path);
+}
+
+std::unique_ptr<MipChain> MipChain::load(const std::string& path, uint64_t sourceSize, int64_t sourceTime) {
+    const int file = open(path.c_str(), O_RDONLY);
+    if(file < 0) {
+        return nullptr;
+    }
+
+    struct stat status;
+    if(fstat(file, &status) != 0 || static_cast<size_t>(status.st_size) < sizeof(Header)) {
+        close(file);
+        return nullptr;
+    }
+
+    const size_t size = status.st_size;
+    void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+    close(file);
+
+    if(mapping == MAP_FAILED) {
+        return nullptr;
+    }
+
+    // Owns the mapping from now on
+    std::unique_ptr<MipChain> chain(new MipChain());
+    chain->mapping = mapping;
+    chain->mappingSize = size;
+
+    const unsigned char* bytes = static_cast<const unsigned char*>(mapping);
+
+    Header header;
+    std::memcpy(&header, bytes, sizeof(Header));
+
+    if(std::memcmp(header.magic, "MIPS", 4) != 0 || header.version != version
+       || header.sourceSize != sourceSize || header.sourceTime != sourceTime
+       || sizeof(Header) + static_cast<size_t>(header.levelCount) * sizeof(LevelEntry) > size) {
+        return nullptr;
+    }
+
+    for(unsigned int i = 0 ; i < header.levelCount ; ++i) {
+        LevelEntry entry;
+        std::memcpy(&entry, bytes + sizeof(Header) + i * sizeof(LevelEntry), sizeof(LevelEntry));
+
+        if(entry.offset + static_cast<uint64_t>(entry.width) * entry.height * 3 > size) {
+            return nullptr;
+        }
+
+        chain->levels.push_back({entry.width, entry.height, bytes + entry.offset});
+    }
+
+    return chain;
+}
+
+const std::vector<MipChain::Level>& MipChain::getLevels() const {
+    return levels;
+}
+
+unsigned int MipChain::getHits() {
+    return hits;
+}
+
+unsigned int MipChain::getMisses() {
+    return misses;
+}
@@ -0,0 +1,101 @@
+/***************************************************************************************************
+ * @file  RingBuffer.cpp
+ * @brief Implementation of the RingBuffer class
+ **************************************************************************************************/
+
+#include "RingBuffer.hpp"
+
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <glad/glad.h>
+
+RingBuffer::RingBuffer(unsigned int frameSize, unsigned int frames)
+    : mapping(nullptr), frameSize(frameSize), fences(frames, nullptr),
+      frame(0), head(0), occupancy(0.0f), stallTime(0.0f) {
+
+    const GLsizeiptr size = static_cast<GLsizeiptr>(frameSize) * frames;
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+
+    if(GLAD_GL_VERSION_4_4) {
+        constexpr GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+        glBufferStorage(GL_ARRAY_BUFFER, size, nullptr, flags);
+        mapping = static_cast<unsigned char*>(glMapBufferRange(GL_ARRAY_BUFFER, 0, size, flags));
+    } else {
+        glBufferData(GL_ARRAY_BUFFER, size, nullptr, GL_STREAM_DRAW);
+    }
+}
+
+RingBuffer::~RingBuffer() {
+    for(void* fence: fences) {
+        if(fence) {
+            glDeleteSync(static_cast<GLsync>(fence));
+        }
+    }
+}
+
+void RingBuffer::beginFrame() {
+    frame = (frame + 1) % fences.size();
+    head = 0;
+    stallTime = 0.0f;
+
+    GLsync fence = static_cast<GLsync>(fences[frame]);
+    if(!fence) {
+        return;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    GLenum status = glClientWaitSync(fence, 0, 0);
+    while(status == GL_TIMEOUT_EXPIRED) {
+        status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1'000'000);
+    }
+
+    if(status != GL_ALREADY_SIGNALED) {
+        stallTime = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    glDeleteSync(fence);
+    fences[frame] = nullptr;
+}
+
+void RingBuffer::endFrame() {
+    fences[frame] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    occupancy = static_cast<float>(head) / frameSize;
+}
+
+unsigned int RingBuffer::write(const void* data, unsigned int size, unsigned int alignment) {
+    const unsigned int start = (head + alignment - 1) / alignment * alignment;
+    if(start + size > frameSize) {
+        throw std::runtime_error("Ring buffer region of " + std::to_string(frameSize) + " bytes is full.");
+    }
+
+    const unsigned int offset = frame * frameSize + start;
+    head = start + size;
+
+    if(mapping) {
+        std::memcpy(mapping + offset, data, size);
+    } else {
+        glBindBuffer(GL_ARRAY_BUFFER, buffer);
+        glBufferSubData(GL_ARRAY_BUFFER, offset, size, data);
+    }
+
+    return offset;
+}
+
+unsigned int RingBuffer::getBuffer() const {
+    return buffer;
+}
+
+bool RingBuffer::isPersistent() const {
+    return mapping != nullptr;
+}
+
+float RingBuffer::getOccupancy() const {
+    return occupancy;
+}
+
+float RingBuffer::getStallTime() const {
+    return stallTime;
+}
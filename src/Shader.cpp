@@ -6,53 +6,410 @@
 #include "Shader.hpp"
 
 #include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
 #include <fstream>
-#include <sstream>
+#include <iterator>
+
+namespace {
+    constexpr char cacheDirectory[] = "cache/shaders/"; ///< Where the program binaries are stored.
+    constexpr GLenum COMPLETION_STATUS = 0x91B1;        ///< GL_COMPLETION_STATUS_KHR, not in glad.
+
+    /**
+     * @brief Checks whether the driver compiles and links shaders on its own threads, through
+     * GL_KHR_parallel_shader_compile or GL_ARB_parallel_shader_compile, and lets it use as many
+     * threads as it wants the first time.
+     * @return Whether the completion of a program can be polled.
+     */
+    bool hasParallelCompile() {
+        static const bool supported = [] {
+            int count = 0;
+            glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+            for(int i = 0 ; i < count ; ++i) {
+                const std::string extension = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+                if(extension != "GL_KHR_parallel_shader_compile" && extension != "GL_ARB_parallel_shader_compile") {
+                    continue;
+                }
+
+                const std::string function = extension[3] == 'K' ? "glMaxShaderCompilerThreadsKHR"
+                                                                  : "glMaxShaderCompilerThreadsARB";
+                auto maxThreads = reinterpret_cast<void (*)(GLuint)>(glfwGetProcAddress(function.c_str()));
+                if(maxThreads) {
+                    maxThreads(0xFFFFFFFF);
+                }
+
+                return true;
+            }
+
+            return false;
+        }();
+
+        return supported;
+    }
 
-Shader::Shader(const std::string* paths, unsigned int count, const std::string& name = "") :
+    /**
+     * @brief Hashes data with the 64-bit FNV-1a hash.
+     * @param hash The hash of the previous data.
+     * @param data The data.
+     * @return The hash of the previous data followed by this data, and a separator.
+     */
+    uint64_t fnv1a(uint64_t hash, const std::string& data) {
+        for(unsigned char c: data) {
+            hash = (hash ^ c) * 0x100000001B3ull;
+        }
+
+        return (hash ^ 0xFF) * 0x100000001B3ull;
+    }
+}
+
+Shader* Shader::bound = nullptr;
+unsigned int Shader::programCount = 0;
+unsigned int Shader::cachedProgramCount = 0;
+float Shader::loadTime = 0.0f;
+float Shader::reloadTime = 0.0f;
+unsigned int Shader::uploadCount = 0;
+unsigned int Shader::skippedUploadCount = 0;
+unsigned int Shader::skippedUseCount = 0;
+
+Shader::Shader(const std::string* paths, unsigned int count, const std::string& name = "",
+               const std::vector<std::string>& varyings, const Defines& defines, bool async) :
     id(glCreateProgram()),
-    name(name) {
+    generation(0),
+    name(name),
+    attributesLocation(-1),
+    state(READING),
+    paths(paths, paths + count),
+    varyings(varyings),
+    defines(defines),
+    cached(false) {
 
     /**** Shader Name ****/
     if(name.size() == 0) {
         this->name = "shader" + std::to_string(id);
     }
 
+    // The files are read on a worker thread, or when the sources are first needed
+    sources = std::async(async ? std::launch::async : std::launch::deferred, [paths = this->paths, defines] {
+        Sources sources;
+        for(const std::string& path: paths) {
+            sources.code.push_back(preprocess(path, defines, sources.files, sources.sourceFiles.emplace_back()));
+        }
+
+        return sources;
+    });
+
+    if(!async) {
+        submit();
+        finish();
+    }
+}
+
+Shader::~Shader() {
+    if(bound == this) {
+        bound = nullptr;
+    }
+
+    for(unsigned int stage: stages) {
+        glDeleteShader(stage);
+    }
+
+    glDeleteProgram(id);
+}
+
+bool Shader::poll() {
+    if(state == READY) {
+        return replacement && swapReplacement();
+    }
+
+    if(state == READING) {
+        if(sources.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            return false;
+        }
+
+        submit();
+    }
+
+    if(state == LINKING) {
+        if(hasParallelCompile()) {
+            int complete;
+            glGetProgramiv(id, COMPLETION_STATUS, &complete);
+            if(!complete) {
+                return false;
+            }
+        }
+
+        finish();
+    }
+
+    return true;
+}
+
+bool Shader::isReady() const {
+    return state == READY;
+}
+
+void Shader::reload() {
+    reloadStart = std::chrono::steady_clock::now();
+    replacement = std::make_unique<Shader>(paths.data(), paths.size(), name, varyings, defines, true);
+}
+
+void Shader::setDefines(const Defines& defines) {
+    this->defines = defines;
+    reload();
+}
+
+bool Shader::dependsOn(const std::string& path) const {
+    return files.contains(path);
+}
+
+bool Shader::swapReplacement() {
+    try {
+        if(!replacement->poll()) {
+            return false;
+        }
+    } catch(const std::runtime_error& exception) {
+        // The current program stays in use until the shaders are fixed
+        std::cerr << exception.what() << '\n';
+        replacement.reset();
+        return false;
+    }
+
+    std::swap(id, replacement->id);
+    std::swap(uniforms, replacement->uniforms);
+    std::swap(files, replacement->files);
+    unknownUniforms.clear();
+    attributesLocation = replacement->attributesLocation;
+
+    // The new program has its default values, the entries are kept as handles point to them
+    for(auto& [location, value]: values) {
+        value.known = false;
+    }
+
+    // The handles resolve their locations again
+    ++generation;
+
+    if(bound == this) {
+        bound = nullptr;
+    }
+
+    // Deletes the previous program
+    replacement.reset();
+    reloadTime = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - reloadStart).count();
+
+    return true;
+}
+
+void Shader::submit() {
+    const auto start = std::chrono::steady_clock::now();
+
+    // Rethrows the errors of the worker thread
+    Sources sources = this->sources.get();
+    files = std::move(sources.files);
+    sourceFiles = std::move(sources.sourceFiles);
+
+    /**** Program Binary ****/
+    cachePath = getCachePath(paths.data(), sources.code, varyings);
+    cached = loadBinary(cachePath);
+    if(!cached) {
+        link(sources.code);
+    }
+
+    state = LINKING;
+    loadTime += std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void Shader::finish() {
+    const auto start = std::chrono::steady_clock::now();
+
+    if(!cached) {
+        for(unsigned int i = 0 ; i < stages.size() ; ++i) {
+            checkShader(paths[i], stages[i], sourceFiles[i]);
+            glDeleteShader(stages[i]);
+        }
+        stages.clear();
+
+        int messageLength;
+        glGetProgramiv(id, GL_INFO_LOG_LENGTH, &messageLength);
+        if(messageLength > 0) {
+            char* message = new char[messageLength];
+            glGetProgramInfoLog(id, messageLength, nullptr, message);
+
+            std::string errorMessage = "Failed to link shader program '";
+            errorMessage += name;
+            errorMessage += "':\n";
+            errorMessage += message;
+
+            delete[] message;
+
+            throw std::runtime_error(errorMessage);
+        }
+
+        saveBinary(cachePath);
+    } else {
+        ++cachedProgramCount;
+    }
+
+    getUniforms();
+
+    auto location = uniforms.find("attributes");
+    if(location != uniforms.end()) {
+        attributesLocation = location->second;
+    }
+
+    state = READY;
+    ++programCount;
+    loadTime += std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void Shader::link(const std::vector<std::string>& sources) {
     /**** Shaders ****/
-    unsigned int shaderID;
-    for(unsigned int i = 0 ; i < count ; ++i) {
-        shaderID = compileShader(paths[i]);
-        glAttachShader(id, shaderID);
-        glDeleteShader(shaderID);
+    // Nothing is queried until the program is linked, so that the driver can work on every stage at once
+    for(unsigned int i = 0 ; i < sources.size() ; ++i) {
+        stages.push_back(compileShader(paths[i], sources[i]));
+        glAttachShader(id, stages.back());
+    }
+
+    /**** Transform Feedback ****/
+    if(!varyings.empty()) {
+        std::vector<const char*> names;
+        for(const std::string& varying: varyings) {
+            names.push_back(varying.c_str());
+        }
+
+        glTransformFeedbackVaryings(id, names.size(), names.data(), GL_INTERLEAVED_ATTRIBS);
     }
 
     /**** Shader Program ****/
+    glProgramParameteri(id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
     glLinkProgram(id);
+}
+
+std::string Shader::getCachePath(const std::string* paths, const std::vector<std::string>& sources,
+                                 const std::vector<std::string>& varyings) {
+    int formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    if(formats == 0) {
+        return "";
+    }
+
+    // Binaries are only valid for the driver that created them
+    uint64_t hash = 0xCBF29CE484222325ull;
+    for(GLenum string: {GL_VENDOR, GL_RENDERER, GL_VERSION}) {
+        hash = fnv1a(hash, reinterpret_cast<const char*>(glGetString(string)));
+    }
+
+    for(unsigned int i = 0 ; i < sources.size() ; ++i) {
+        hash = fnv1a(hash, paths[i]);
+        hash = fnv1a(hash, sources[i]);
+    }
+
+    for(const std::string& varying: varyings) {
+        hash = fnv1a(hash, varying);
+    }
+
+    char name[17];
+    std::snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(hash));
+
+    return cacheDirectory + std::string(name) + ".bin";
+}
+
+bool Shader::loadBinary(const std::string& path) {
+    if(path.empty()) {
+        return false;
+    }
+
+    std::ifstream file(path, std::ios::binary);
+    if(!file.is_open()) {
+        return false;
+    }
+
+    uint32_t format;
+    file.read(reinterpret_cast<char*>(&format), sizeof(format));
+    const std::vector<char> binary((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    if(!file.eof() || binary.empty()) {
+        return false;
+    }
 
+    glProgramBinary(id, format, binary.data(), binary.size());
+
+    // Fails if the driver changed in a way its strings don't tell, the program is then compiled
+    int status;
+    glGetProgramiv(id, GL_LINK_STATUS, &status);
+
+    return status == GL_TRUE;
+}
+
+void Shader::saveBinary(const std::string& path) const {
+    if(path.empty()) {
+        return;
+    }
+
+    int length = 0;
+    glGetProgramiv(id, GL_PROGRAM_BINARY_LENGTH, &length);
+    if(length == 0) {
+        return;
+    }
+
+    std::vector<char> binary(length);
+    GLenum format;
+    glGetProgramBinary(id, length, nullptr, &format, binary.data());
+
+    // The cache only speeds up the next startups, failing to write it is not an error
+    std::error_code error;
+    std::filesystem::create_directories(cacheDirectory, error);
+
+    const std::string temporary = path + ".tmp";
+    std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+    const uint32_t storedFormat = format;
+    file.write(reinterpret_cast<const char*>(&storedFormat), sizeof(storedFormat));
+    file.write(binary.data(), binary.size());
+    file.close();
+
+    if(file) {
+        std::filesystem::rename(temporary, path, error);
+    }
+}
+
+unsigned int Shader::compileShader(const std::string& path, const std::string& source) {
+    const char* code = source.c_str();
+    unsigned int id = glCreateShader(getShaderType(path).first);
+    glShaderSource(id, 1, &code, nullptr);
+    glCompileShader(id);
+
+    return id;
+}
+
+void Shader::checkShader(const std::string& path, unsigned int shader,
+                         const std::vector<std::string>& sourceFiles) const {
     int messageLength;
-    glGetProgramiv(id, GL_INFO_LOG_LENGTH, &messageLength);
+    glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &messageLength);
     if(messageLength > 0) {
         char* message = new char[messageLength];
-        glGetProgramInfoLog(id, messageLength, nullptr, message);
+        glGetShaderInfoLog(shader, messageLength, nullptr, message);
 
-        std::string errorMessage = "Failed to link shader program '";
+        std::string errorMessage = "Failed to compile " + getShaderType(path).second + " shader for shader program '";
         errorMessage += name;
         errorMessage += "':\n";
         errorMessage += message;
 
         delete[] message;
 
+        // Errors are reported as file index(line) or file index:line depending on the driver
+        errorMessage += "Files:\n";
+        for(unsigned int i = 0 ; i < sourceFiles.size() ; ++i) {
+            errorMessage += "  " + std::to_string(i) + ": " + sourceFiles[i] + '\n';
+        }
+
         throw std::runtime_error(errorMessage);
     }
-
-    getUniforms();
 }
 
-Shader::~Shader() {
-    glDeleteProgram(id);
-}
-
-unsigned int Shader::compileShader(const std::string& path) {
+std::pair<unsigned int, std::string> Shader::getShaderType(const std::string& path) {
     std::string extension = path.substr(path.find_last_of('.') + 1);
 
     std::string shaderTypeName;
@@ -85,38 +442,139 @@ unsigned int Shader::compileShader(const std::string& path) {
             break;
     }
 
+    return {shaderType, shaderTypeName};
+}
+
+std::string Shader::preprocess(const std::string& path, const Defines& defines,
+                               std::unordered_set<std::string>& files, std::vector<std::string>& sourceFiles) {
+    std::unordered_set<std::string> included;
+    std::string source = readSource(path, included, sourceFiles);
+    files.insert(included.begin(), included.end());
+
+    if(defines.empty()) {
+        return source;
+    }
+
+    // The definitions must follow the #version directive, which must come first
+    size_t position = source.starts_with("#version") ? 0 : source.find("\n#version");
+    position = position == std::string::npos ? 0 : source.find('\n', position + 1) + 1;
+
+    // Nothing is included before the #version directive, so the lines before it are the file's
+    const unsigned int line = std::count(source.begin(), source.begin() + position, '\n') + 1;
+
+    std::string definitions;
+    for(const auto& [macro, value]: defines) {
+        definitions += "#define " + macro + ' ' + value + '\n';
+    }
+    definitions += "#line " + std::to_string(line) + " 0\n";
+
+    return source.insert(position, definitions);
+}
+
+std::string Shader::readSource(const std::string& path, std::unordered_set<std::string>& included,
+                               std::vector<std::string>& sourceFiles, unsigned int depth) {
+    if(depth > 8) {
+        throw std::runtime_error("Too many nested includes in " + path + ".");
+    }
+
+    // Each file is only included once, so that included files can include what they depend on
+    if(!included.insert(std::filesystem::path(path).lexically_normal().string()).second) {
+        return "";
+    }
+
     std::ifstream file(path);
     if(!file.is_open()) {
-        throw std::runtime_error(std::string("Failed to open " + shaderTypeName + " shader."));
+        throw std::runtime_error("Failed to open shader file " + path + ".");
     }
 
-    std::string rawCode = (std::stringstream() << file.rdbuf()).str();
-    const char* code = rawCode.c_str();
-    unsigned int id = glCreateShader(shaderType);
-    glShaderSource(id, 1, &code, nullptr);
-    glCompileShader(id);
-
-    int messageLength;
-    glGetShaderiv(id, GL_INFO_LOG_LENGTH, &messageLength);
-    if(messageLength > 0) {
-        char* message = new char[messageLength];
-        glGetShaderInfoLog(id, messageLength, nullptr, message);
+    const std::string directory = path.substr(0, path.find_last_of('/') + 1);
+    const std::string index = std::to_string(sourceFiles.size());
+    sourceFiles.push_back(path);
+
+    // The first file starts with its #version directive, which nothing may precede
+    std::string source = depth > 0 ? "#line 1 " + index + '\n' : "";
+    std::string line;
+    unsigned int number = 0;
+    while(std::getline(file, line)) {
+        ++number;
+
+        if(line.starts_with("#include")) {
+            const size_t first = line.find('"');
+            const size_t last = line.find_last_of('"');
+            if(first == std::string::npos || last == first) {
+                throw std::runtime_error("Malformed include in " + path + ": " + line);
+            }
 
-        std::string errorMessage = "Failed to compile " + shaderTypeName + " shader for shader program '";
-        errorMessage += name;
-        errorMessage += "':\n";
-        errorMessage += message;
+            // Included paths are relative to the including file
+            const std::string content = readSource(directory + line.substr(first + 1, last - first - 1),
+                                                   included, sourceFiles, depth + 1);
 
-        delete[] message;
+            // The include line becomes the directive going back to this file
+            if(!content.empty()) {
+                source += content + "#line " + std::to_string(number + 1) + ' ' + index;
+            }
+        } else {
+            source += line;
+        }
 
-        throw std::runtime_error(errorMessage);
+        source += '\n';
     }
 
-    return id;
+    return source;
 }
 
 void Shader::use() {
+    if(bound == this) {
+        ++skippedUseCount;
+        return;
+    }
+
     glUseProgram(id);
+    bound = this;
+}
+
+Shader* Shader::getBound() {
+    return bound;
+}
+
+unsigned int Shader::getProgramCount() {
+    return programCount;
+}
+
+unsigned int Shader::getCachedProgramCount() {
+    return cachedProgramCount;
+}
+
+float Shader::getLoadTime() {
+    return loadTime;
+}
+
+float Shader::getReloadTime() {
+    return reloadTime;
+}
+
+unsigned int Shader::getUploadCount() {
+    return uploadCount;
+}
+
+unsigned int Shader::getSkippedUploadCount() {
+    return skippedUploadCount;
+}
+
+unsigned int Shader::getSkippedUseCount() {
+    return skippedUseCount;
+}
+
+void Shader::resetCounts() {
+    uploadCount = 0;
+    skippedUploadCount = 0;
+    skippedUseCount = 0;
+}
+
+void Shader::setAttributes(unsigned int attributes) {
+    if(attributesLocation != -1 && values[attributesLocation].update(attributes)) {
+        glUniform1ui(attributesLocation, attributes);
+    }
 }
 
 void Shader::getUniforms() {
@@ -152,6 +610,15 @@ void Shader::getUniforms() {
     delete[] name;
 }
 
+void Shader::warnUnknownUniform(const std::string& uniform) {
+    if(!unknownUniforms.contains(uniform)) {
+        std::cout << "The uniform named '" << uniform << "' is unknown or unused";
+        std::cout << " in shader program '" << name << "'.\n";
+
+        unknownUniforms.emplace(uniform, true);
+    }
+}
+
 void Shader::setUniform(int location, int value) const {
     glUniform1i(location, value);
 }
@@ -207,3 +674,35 @@ void Shader::setUniform(int location, const vec4& vec) const {
 void Shader::setUniform(int location, const mat4& matrix) const {
     glUniformMatrix4fv(location, 1, false, &(matrix[0][0]));
 }
+
+void Shader::setProgramUniform(unsigned int program, int location, int value) {
+    glProgramUniform1i(program, location, value);
+}
+
+void Shader::setProgramUniform(unsigned int program, int location, unsigned int value) {
+    glProgramUniform1ui(program, location, value);
+}
+
+void Shader::setProgramUniform(unsigned int program, int location, bool value) {
+    glProgramUniform1i(program, location, static_cast<int>(value));
+}
+
+void Shader::setProgramUniform(unsigned int program, int location, float value) {
+    glProgramUniform1f(program, location, value);
+}
+
+void Shader::setProgramUniform(unsigned int program, int location, const vec2& value) {
+    glProgramUniform2fv(program, location, 1, &value.x);
+}
+
+void Shader::setProgramUniform(unsigned int program, int location, const vec3& value) {
+    glProgramUniform3fv(program, location, 1, &value.x);
+}
+
+void Shader::setProgramUniform(unsigned int program, int location, const vec4& value) {
+    glProgramUniform4fv(program, location, 1, &value.x);
+}
+
+void Shader::setProgramUniform(unsigned int program, int location, const mat4& value) {
+    glProgramUniformMatrix4fv(program, location, 1, false, &(value[0][0]));
+}
@@ -6,23 +6,35 @@
 #include "Texture.hpp"
 
 #include <glad/glad.h>
+#include <chrono>
 
-Texture::Texture(const std::string& path) {
-    Image image(path);
+std::atomic<float> Texture::loadTime = 0.0f;
 
+Texture::Texture(const std::string& path, bool async) {
     glGenTextures(1, &id);
+
+    if(!async) {
+        upload(*MipChain::get(path));
+        return;
+    }
+
+    // Shown until the levels are loaded
+    const unsigned char placeholder[3]{128, 128, 128};
     glBindTexture(GL_TEXTURE_2D, id);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, image.getWidth(), image.getHeight(), 0, GL_RGB,
-                 GL_UNSIGNED_BYTE, image.getData());
-    glGenerateMipmap(GL_TEXTURE_2D);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, 1, 1, 0, GL_RGB, GL_UNSIGNED_BYTE, placeholder);
+
+    levels = std::async(std::launch::async, [path] {
+        const auto start = std::chrono::steady_clock::now();
+        auto levels = MipChain::get(path);
+        loadTime += std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        return levels;
+    });
 }
 
 Texture::Texture(const Image& image) {
     glGenTextures(1, &id);
-    glBindTexture(GL_TEXTURE_2D, id);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, image.getWidth(), image.getHeight(), 0, GL_RGB,
-                 GL_UNSIGNED_BYTE, image.getData());
-    glGenerateMipmap(GL_TEXTURE_2D);
+    upload(image);
 }
 
 Texture::~Texture() {
@@ -34,6 +46,59 @@ void Texture::bind(unsigned int texUnit) const {
     glBindTexture(GL_TEXTURE_2D, id);
 }
 
+bool Texture::poll() {
+    if(!levels.valid()) {
+        return true;
+    }
+
+    if(levels.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+        return false;
+    }
+
+    // Rethrows the errors of the worker thread
+    const std::unique_ptr<MipChain> loaded = levels.get();
+
+    // The texture units keep what is bound to them, whichever is active
+    int previous;
+    glGetIntegerv(GL_TEXTURE_BINDING_2D, &previous);
+    upload(*loaded);
+    glBindTexture(GL_TEXTURE_2D, previous);
+
+    return true;
+}
+
+bool Texture::isReady() const {
+    return !levels.valid();
+}
+
+float Texture::getLoadTime() {
+    return loadTime;
+}
+
+void Texture::upload(const Image& image) {
+    glBindTexture(GL_TEXTURE_2D, id);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, image.getWidth(), image.getHeight(), 0, GL_RGB,
+                 GL_UNSIGNED_BYTE, image.getData());
+    glGenerateMipmap(GL_TEXTURE_2D);
+}
+
+void Texture::upload(const MipChain& chain) {
+    // The rows of the levels are tightly packed, and most of them aren't a multiple of 4 bytes
+    int alignment;
+    glGetIntegerv(GL_UNPACK_ALIGNMENT, &alignment);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    glBindTexture(GL_TEXTURE_2D, id);
+
+    const std::vector<MipChain::Level>& levels = chain.getLevels();
+    for(unsigned int i = 0 ; i < levels.size() ; ++i) {
+        glTexImage2D(GL_TEXTURE_2D, i, GL_RGB, levels[i].width, levels[i].height, 0, GL_RGB,
+                     GL_UNSIGNED_BYTE, levels[i].data);
+    }
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, alignment);
+}
+
 Texture::Texture(const vec3& color) {
     unsigned char c[3]{
         static_cast<unsigned char>(color.x * 255.0f),
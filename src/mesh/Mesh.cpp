@@ -5,28 +5,102 @@
 
 #include "mesh/Mesh.hpp"
 
+#include <algorithm>
+#include <bit>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <numeric>
+#include <stdexcept>
+#include <utility>
 #include <glad/glad.h>
 
-Mesh::Mesh(unsigned int primitive)
-    : primitive(primitive),
-      shouldBind(true),
-      attributes(0b00000001) {
+#include "mesh/optimization.hpp"
+#include "mesh/simplification.hpp"
+
+namespace {
+    /**
+     * @brief Converts a float to a half float. Values too small to be represented become 0.
+     * @param value The float.
+     * @return The bits of the half float.
+     */
+    uint16_t toHalf(float value) {
+        const uint32_t bits = std::bit_cast<uint32_t>(value);
+        const uint16_t sign = (bits >> 16) & 0x8000;
+        int exponent = static_cast<int>((bits >> 23) & 0xFF) - 127 + 15;
+        uint32_t mantissa = (bits & 0x7FFFFF) + 0x1000; // Rounds to the nearest
+
+        if(mantissa & 0x800000) {
+            mantissa = 0;
+            ++exponent;
+        }
+
+        if(exponent <= 0) {
+            return sign;
+        } else if(exponent >= 31) {
+            return sign | 0x7C00;
+        }
+
+        return sign | (exponent << 10) | (mantissa >> 13);
+    }
 
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
-    glGenBuffers(1, &EBO);
+    /**
+     * @brief Converts a float in [-1 ; 1] to a 10-bit signed normalized integer.
+     * @param value The float.
+     * @return The 10 bits of the integer.
+     */
+    uint32_t toSnorm10(float value) {
+        return static_cast<uint32_t>(std::lround(std::clamp(value, -1.0f, 1.0f) * 511.0f)) & 0x3FF;
+    }
+
+    /**
+     * @brief Converts a float in [0 ; 1] to an 8-bit unsigned normalized integer.
+     * @param value The float.
+     * @return The integer.
+     */
+    uint8_t toUnorm8(float value) {
+        return static_cast<uint8_t>(std::lround(std::clamp(value, 0.0f, 1.0f) * 255.0f));
+    }
 }
 
+Mesh::Mesh(unsigned int primitive, u_int8_t attributes)
+    : primitive(primitive),
+      shouldBind(true), quantized(false), released(false), retention(KEEP),
+      vertexCount(0), indexCount(0), lod(0),
+      indexType(GL_UNSIGNED_INT), gpuSize(0), savedGPUSize(0),
+      instanceStride(0), instanceCount(0),
+      attributes(attributes | POSITION) { }
+
+Mesh::Mesh(unsigned int primitive, u_int8_t attributes,
+           std::vector<float>&& data, std::vector<unsigned int>&& indices)
+    : primitive(primitive),
+      shouldBind(true), quantized(false), released(false), retention(KEEP),
+      vertexCount(0), indexCount(0), lod(0),
+      indexType(GL_UNSIGNED_INT), gpuSize(0), savedGPUSize(0),
+      instanceStride(0), instanceCount(0),
+      attributes(attributes | POSITION),
+      data(std::move(data)),
+      indices(std::move(indices)) { }
+
+unsigned int Mesh::copyCount = 0;
+
 Mesh::Mesh(const Mesh& mesh)
     : primitive(mesh.getPrimitive()),
-      shouldBind(true),
+      shouldBind(true), quantized(mesh.quantized), released(mesh.released),
+      retention(mesh.retention), regenerator(mesh.regenerator),
+      vertexCount(0), indexCount(0), lods(mesh.lods), lod(mesh.lod), clusters(mesh.clusters),
+      indexType(GL_UNSIGNED_INT), gpuSize(0), savedGPUSize(0),
+      instanceStride(0), instanceCount(0),
       attributes(mesh.getAttributes()),
       data(*mesh.getData()),
       indices(*mesh.getIndices()) {
 
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
-    glGenBuffers(1, &EBO);
+    if(!mesh.instanceComponents.empty()) {
+        setInstanceLayout(mesh.instanceComponents);
+    }
+
+    ++copyCount;
 }
 
 Mesh& Mesh::operator =(const Mesh& mesh) {
@@ -34,103 +108,182 @@ Mesh& Mesh::operator =(const Mesh& mesh) {
         return *this;
     }
 
-    glDeleteVertexArrays(1, &VAO);
-    glDeleteBuffers(1, &VBO);
-    glDeleteBuffers(1, &EBO);
+    ++copyCount;
 
     primitive = mesh.getPrimitive();
     shouldBind = true;
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
-    glGenBuffers(1, &EBO);
+    quantized = mesh.quantized;
+    released = mesh.released;
+    retention = mesh.retention;
+    regenerator = mesh.regenerator;
+    vertexCount = 0;
+    indexCount = 0;
+    lods = mesh.lods;
+    lod = mesh.lod;
+    clusters = mesh.clusters;
+    gpuSize = 0;
+    savedGPUSize = 0;
+    VAO = VertexArray();
+    VBO = Buffer();
+    EBO = Buffer();
+    IBO = Buffer();
+    instanceComponents.clear();
+    instanceStride = 0;
+    instanceCount = 0;
     attributes = mesh.getAttributes();
     data = *mesh.getData();
     indices = *mesh.getIndices();
 
+    if(!mesh.instanceComponents.empty()) {
+        setInstanceLayout(mesh.instanceComponents);
+    }
+
     return *this;
 }
 
-Mesh::~Mesh() {
-    glDeleteVertexArrays(1, &VAO);
-    glDeleteBuffers(1, &VBO);
-    glDeleteBuffers(1, &EBO);
+void Mesh::draw() {
+    bind();
+
+    if(indexCount == 0) {
+        glDrawArrays(primitive, 0, vertexCount);
+    } else if(lods.empty()) {
+        glDrawElements(primitive, indexCount, indexType, nullptr);
+    } else {
+        const unsigned int offset = lods[lod].firstIndex * (indexType == GL_UNSIGNED_SHORT ? 2 : 4);
+        glDrawElements(primitive, lods[lod].indexCount, indexType, reinterpret_cast<void*>(offset));
+    }
 }
 
-void Mesh::draw() {
-    if(shouldBind) {
-        bindBuffers();
-        shouldBind = false;
+void Mesh::drawInstanced(unsigned int count) {
+    bind();
+
+    if(indexCount == 0) {
+        glDrawArraysInstanced(primitive, 0, vertexCount, count);
+    } else if(lods.empty()) {
+        glDrawElementsInstanced(primitive, indexCount, indexType, nullptr, count);
+    } else {
+        const unsigned int offset = lods[lod].firstIndex * (indexType == GL_UNSIGNED_SHORT ? 2 : 4);
+        glDrawElementsInstanced(primitive, lods[lod].indexCount, indexType, reinterpret_cast<void*>(offset), count);
     }
+}
+
+void Mesh::bind() {
+    upload();
 
     glBindVertexArray(VAO);
 
-    int shader;
-    glGetIntegerv(GL_CURRENT_PROGRAM, &shader);
-    glUniform1ui(glGetUniformLocation(shader, "attributes"), static_cast<unsigned int>(attributes));
+    if(Shader* shader = Shader::getBound()) {
+        shader->setAttributes(attributes);
+    }
+}
 
-    if(indices.empty()) {
-        glDrawArrays(primitive, 0, data.size() / getStride());
-    } else {
-        glDrawElements(primitive, indices.size(), GL_UNSIGNED_INT, nullptr);
+void Mesh::drawInstanced() {
+    if(instanceCount > 0) {
+        drawInstanced(instanceCount);
+    }
+}
+
+void Mesh::setInstanceLayout(const std::vector<unsigned int>& components) {
+    instanceComponents = components;
+    instanceStride = std::accumulate(components.begin(), components.end(), 0u);
+    instanceCount = 0;
+    attributes |= INSTANCED;
+
+    glBindVertexArray(VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, IBO);
+
+    const unsigned int stride = instanceStride * sizeof(float);
+    unsigned int offset = 0;
+    unsigned int location = FIRST_INSTANCE_LOCATION;
+
+    for(unsigned int count: components) {
+        glVertexAttribPointer(location, count, GL_FLOAT, false, stride, reinterpret_cast<void*>(offset));
+        glVertexAttribDivisor(location, 1);
+        glEnableVertexAttribArray(location);
+
+        offset += count * sizeof(float);
+        ++location;
     }
 }
 
+void Mesh::setInstances(std::span<const float> instances) {
+    // The buffer is orphaned so that the previous frame's draws don't have to finish first
+    glBindBuffer(GL_ARRAY_BUFFER, IBO);
+    glBufferData(GL_ARRAY_BUFFER, instances.size_bytes(), instances.data(), GL_STREAM_DRAW);
+
+    instanceCount = instances.size() / instanceStride;
+}
+
+unsigned int Mesh::getInstanceCount() const {
+    return instanceCount;
+}
+
+void Mesh::setInstanceAttribute(unsigned int location, unsigned int buffer, int components,
+                                unsigned int type, bool normalized, unsigned int offset) {
+    upload();
+
+    glBindVertexArray(VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    glVertexAttribPointer(location, components, type, normalized, 0, reinterpret_cast<void*>(offset));
+    glVertexAttribDivisor(location, 1);
+    glEnableVertexAttribArray(location);
+}
+
+void Mesh::reserve(unsigned int vertices, unsigned int indices) {
+    data.reserve(vertices * getStride());
+    this->indices.reserve(indices);
+}
+
+void Mesh::addVertices(std::span<const float> vertices) {
+    data.insert(data.end(), vertices.begin(), vertices.end());
+}
+
+void Mesh::addIndices(std::span<const unsigned int> indices) {
+    this->indices.insert(this->indices.end(), indices.begin(), indices.end());
+}
+
 void Mesh::addPosition(float x, float y, float z) {
-    data.push_back(x);
-    data.push_back(y);
-    data.push_back(z);
+    data.insert(data.end(), {x, y, z});
 }
 
 void Mesh::addPosition(const vec3& position) {
-    data.push_back(position.x);
-    data.push_back(position.y);
-    data.push_back(position.z);
+    data.insert(data.end(), {position.x, position.y, position.z});
 }
 
 void Mesh::addNormal(float x, float y, float z) {
-    attributes |= 0b00000010;
+    attributes |= NORMAL;
 
-    data.push_back(x);
-    data.push_back(y);
-    data.push_back(z);
+    data.insert(data.end(), {x, y, z});
 }
 
 void Mesh::addNormal(const vec3& normal) {
-    attributes |= 0b00000010;
+    attributes |= NORMAL;
 
-    data.push_back(normal.x);
-    data.push_back(normal.y);
-    data.push_back(normal.z);
+    data.insert(data.end(), {normal.x, normal.y, normal.z});
 }
 
 void Mesh::addTexCoord(float x, float y) {
-    attributes |= 0b00000100;
+    attributes |= TEX_COORDS;
 
-    data.push_back(x);
-    data.push_back(y);
+    data.insert(data.end(), {x, y});
 }
 
 void Mesh::addTexCoord(const vec2& texCoord) {
-    attributes |= 0b00000100;
+    attributes |= TEX_COORDS;
 
-    data.push_back(texCoord.x);
-    data.push_back(texCoord.y);
+    data.insert(data.end(), {texCoord.x, texCoord.y});
 }
 
 void Mesh::addColor(float r, float g, float b) {
-    attributes |= 0b00001000;
+    attributes |= COLOR;
 
-    data.push_back(r);
-    data.push_back(g);
-    data.push_back(b);
+    data.insert(data.end(), {r, g, b});
 }
 
 void Mesh::addColor(const vec3& color) {
-    attributes |= 0b00001000;
+    attributes |= COLOR;
 
-    data.push_back(color.x);
-    data.push_back(color.y);
-    data.push_back(color.z);
+    data.insert(data.end(), {color.x, color.y, color.z});
 }
 
 void Mesh::addIndex(unsigned int index) {
@@ -138,23 +291,16 @@ void Mesh::addIndex(unsigned int index) {
 }
 
 void Mesh::addTriangle(unsigned int top, unsigned int left, unsigned int right) {
-    indices.push_back(top);
-    indices.push_back(left);
-    indices.push_back(right);
+    indices.insert(indices.end(), {top, left, right});
 }
 
 void Mesh::addFace(unsigned int topL, unsigned int bottomL,
                    unsigned int bottomR, unsigned int topR) {
 
-    // First Triangle
-    indices.push_back(topL);
-    indices.push_back(bottomL);
-    indices.push_back(bottomR);
-
-    // Second Triangle
-    indices.push_back(topL);
-    indices.push_back(bottomR);
-    indices.push_back(topR);
+    indices.insert(indices.end(), {
+        topL, bottomL, bottomR, // First Triangle
+        topL, bottomR, topR     // Second Triangle
+    });
 }
 
 unsigned int Mesh::getPrimitive() const {
@@ -173,14 +319,321 @@ const std::vector<unsigned int>* Mesh::getIndices() const {
     return &indices;
 }
 
+unsigned int Mesh::getCopyCount() {
+    return copyCount;
+}
+
+void Mesh::generateLODs(std::span<const float> ratios, float maxError) {
+    if(primitive != GL_TRIANGLES || indices.empty() || released) {
+        return;
+    }
+
+    const unsigned int triangles = indices.size() / 3;
+    lods = {LOD{0, static_cast<unsigned int>(indices.size()), 0.0f}};
+    lod = 0;
+
+    std::vector<unsigned int> previous = indices;
+    for(float ratio: ratios) {
+        float error;
+        std::vector<unsigned int> level = Simplification::simplify(data, previous, getStride(),
+                                                                   ratio * triangles, maxError, &error);
+
+        // The error bound was reached before the ratio, coarser levels would be the same
+        if(level.size() == previous.size()) {
+            break;
+        }
+
+        lods.push_back(LOD{
+            static_cast<unsigned int>(indices.size()),
+            static_cast<unsigned int>(level.size()),
+            std::max(error, lods.back().error)
+        });
+        indices.insert(indices.end(), level.begin(), level.end());
+        previous = std::move(level);
+    }
+
+    shouldBind = true;
+}
+
+unsigned int Mesh::selectLOD(float distance, float tolerance) const {
+    unsigned int selected = 0;
+    for(unsigned int i = 1 ; i < lods.size() ; ++i) {
+        if(lods[i].error <= tolerance * distance) {
+            selected = i;
+        }
+    }
+
+    return selected;
+}
+
+void Mesh::setLOD(unsigned int lod) {
+    this->lod = lod;
+}
+
+const std::vector<Mesh::LOD>& Mesh::getLODs() const {
+    return lods;
+}
+
+void Mesh::buildClusters(unsigned int maxTriangles, unsigned int maxVertices) {
+    if(primitive != GL_TRIANGLES || indices.empty() || released) {
+        return;
+    }
+
+    const unsigned int count = lods.empty() ? indices.size() : lods[0].indexCount;
+    std::vector<unsigned int> firstLevel(indices.begin(), indices.begin() + count);
+
+    clusters = Clustering::build(data, firstLevel, getStride(), maxTriangles, maxVertices);
+    std::copy(firstLevel.begin(), firstLevel.end(), indices.begin());
+    shouldBind = true;
+}
+
+const std::vector<Clustering::Cluster>& Mesh::getClusters() const {
+    return clusters;
+}
+
+void Mesh::drawClusters(std::span<const unsigned int> visible) {
+    if(visible.empty()) {
+        return;
+    }
+
+    bind();
+
+    const unsigned int indexSize = indexType == GL_UNSIGNED_SHORT ? 2 : 4;
+    std::vector<int> counts;
+    std::vector<const void*> offsets;
+    counts.reserve(visible.size());
+    offsets.reserve(visible.size());
+
+    for(unsigned int i: visible) {
+        counts.push_back(clusters[i].indexCount);
+        offsets.push_back(reinterpret_cast<const void*>(static_cast<uintptr_t>(clusters[i].firstIndex * indexSize)));
+    }
+
+    glMultiDrawElements(primitive, counts.data(), indexType, offsets.data(), visible.size());
+}
+
+void Mesh::optimize() {
+    if(primitive != GL_TRIANGLES || indices.empty() || released) {
+        return;
+    }
+
+    // Each range is reordered separately so that the levels and clusters stay valid
+    std::vector<std::pair<unsigned int, unsigned int>> ranges;
+    for(const Clustering::Cluster& cluster: clusters) {
+        ranges.emplace_back(cluster.firstIndex, cluster.indexCount);
+    }
+    for(unsigned int i = clusters.empty() ? 0 : 1 ; i < lods.size() ; ++i) {
+        ranges.emplace_back(lods[i].firstIndex, lods[i].indexCount);
+    }
+    if(ranges.empty()) {
+        ranges.emplace_back(0, indices.size());
+    }
+
+    // The vertices of a range are renumbered densely so that reordering it only costs its size,
+    // not the size of the whole mesh
+    std::vector<unsigned int> localIds(data.size() / getStride(), UINT_MAX);
+    std::vector<unsigned int> vertices;
+    std::vector<unsigned int> range;
+
+    for(const auto& [firstIndex, indexCount]: ranges) {
+        const auto first = indices.begin() + firstIndex;
+
+        vertices.clear();
+        range.clear();
+        for(auto index = first ; index != first + indexCount ; ++index) {
+            unsigned int& id = localIds[*index];
+            if(id == UINT_MAX) {
+                id = vertices.size();
+                vertices.push_back(*index);
+            }
+            range.push_back(id);
+        }
+
+        Optimization::optimizeVertexCache(range, vertices.size());
+
+        for(unsigned int i = 0 ; i < indexCount ; ++i) {
+            first[i] = vertices[range[i]];
+        }
+        for(unsigned int vertex: vertices) {
+            localIds[vertex] = UINT_MAX;
+        }
+    }
+
+    Optimization::optimizeVertexFetch(data, indices, getStride());
+    shouldBind = true;
+}
+
+float Mesh::getACMR(unsigned int cacheSize) const {
+    if(primitive != GL_TRIANGLES || indices.empty() || released) {
+        return 0.0f;
+    }
+
+    const unsigned int count = lods.empty() ? indices.size() : lods[0].indexCount;
+    return Optimization::getACMR(std::span(indices).first(count), data.size() / getStride(), cacheSize);
+}
+
+void Mesh::setQuantized(bool quantized) {
+    if(quantized != this->quantized) {
+        this->quantized = quantized;
+        shouldBind = true;
+    }
+}
+
+void Mesh::setRetention(Retention retention) {
+    this->retention = retention;
+}
+
+void Mesh::setRegenerator(std::function<Mesh()> regenerator) {
+    this->regenerator = std::move(regenerator);
+}
+
+void Mesh::reupload() {
+    if(regenerator) {
+        released = true;
+    } else if(released) {
+        throw std::runtime_error("Mesh data was released and cannot be uploaded again.");
+    }
+
+    shouldBind = true;
+}
+
+unsigned int Mesh::getCPUSize() const {
+    return data.capacity() * sizeof(float) + indices.capacity() * sizeof(unsigned int);
+}
+
+unsigned int Mesh::getGPUSize() const {
+    return gpuSize;
+}
+
+unsigned int Mesh::getSavedGPUSize() const {
+    return savedGPUSize;
+}
+
+void Mesh::upload() {
+    if(!shouldBind) {
+        return;
+    }
+
+    if(released) {
+        if(!regenerator) {
+            throw std::runtime_error("Mesh data was released and cannot be uploaded again.");
+        }
+
+        Mesh mesh = regenerator();
+        attributes = mesh.attributes | (attributes & INSTANCED);
+        data = std::move(mesh.data);
+        indices = std::move(mesh.indices);
+        lods = std::move(mesh.lods);
+        lod = 0;
+        clusters = std::move(mesh.clusters);
+        released = false;
+    }
+
+    bindBuffers();
+    shouldBind = false;
+
+    if(retention == RELEASE) {
+        std::vector<float>().swap(data);
+        std::vector<unsigned int>().swap(indices);
+        released = true;
+    } else if(retention == KEEP_POSITIONS) {
+        const unsigned int stride = getStride();
+        std::vector<float> positions;
+        positions.reserve(vertexCount * 3);
+
+        for(unsigned int i = 0 ; i < vertexCount ; ++i) {
+            positions.insert(positions.end(), &data[i * stride], &data[i * stride + 3]);
+        }
+
+        data = std::move(positions);
+        released = true;
+    }
+}
+
 void Mesh::bindBuffers() {
-    const unsigned int stride = getStride() * sizeof(float);
-    int offset = 0;
+    vertexCount = data.size() / getStride();
+    indexCount = indices.size();
 
     glBindVertexArray(VAO);
-
     glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, data.size() * sizeof(float), data.data(), GL_STATIC_DRAW);
+
+    if(quantized) {
+        const std::vector<unsigned char> packed = packQuantizedData();
+
+        glBufferData(GL_ARRAY_BUFFER, packed.size(), packed.data(), GL_STATIC_DRAW);
+        gpuSize = packed.size();
+    } else {
+        glBufferData(GL_ARRAY_BUFFER, data.size() * sizeof(float), data.data(), GL_STATIC_DRAW);
+        gpuSize = data.size() * sizeof(float);
+    }
+
+    setAttributePointers();
+
+    if(!indices.empty()) {
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+
+        // Indices are stored on 16 bits whenever they all fit
+        if(*std::max_element(indices.begin(), indices.end()) <= UINT16_MAX) {
+            const std::vector<uint16_t> shortIndices(indices.begin(), indices.end());
+
+            indexType = GL_UNSIGNED_SHORT;
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER,
+                         shortIndices.size() * sizeof(uint16_t),
+                         shortIndices.data(), GL_STATIC_DRAW);
+            gpuSize += shortIndices.size() * sizeof(uint16_t);
+        } else {
+            indexType = GL_UNSIGNED_INT;
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER,
+                         indices.size() * sizeof(unsigned int),
+                         indices.data(), GL_STATIC_DRAW);
+            gpuSize += indices.size() * sizeof(unsigned int);
+        }
+    }
+
+    savedGPUSize = (data.size() + indices.size()) * 4 - gpuSize;
+}
+
+std::vector<unsigned char> Mesh::packQuantizedData() const {
+    const unsigned int count = data.size() / getStride();
+    std::vector<unsigned char> packed(count * getVertexSize());
+
+    const float* vertex = data.data();
+    unsigned char* out = packed.data();
+    for(unsigned int i = 0 ; i < count ; ++i) {
+        std::memcpy(out, vertex, 3 * sizeof(float));
+        vertex += 3;
+        out += 3 * sizeof(float);
+
+        if(attributes & NORMAL) {
+            const uint32_t normal = toSnorm10(vertex[0]) | toSnorm10(vertex[1]) << 10 | toSnorm10(vertex[2]) << 20;
+            std::memcpy(out, &normal, sizeof(normal));
+            vertex += 3;
+            out += 4;
+        }
+
+        if(attributes & TEX_COORDS) {
+            const uint16_t texCoords[2]{toHalf(vertex[0]), toHalf(vertex[1])};
+            std::memcpy(out, texCoords, sizeof(texCoords));
+            vertex += 2;
+            out += 4;
+        }
+
+        if(attributes & COLOR) {
+            out[0] = toUnorm8(vertex[0]);
+            out[1] = toUnorm8(vertex[1]);
+            out[2] = toUnorm8(vertex[2]);
+            out[3] = 255;
+            vertex += 3;
+            out += 4;
+        }
+    }
+
+    return packed;
+}
+
+void Mesh::setAttributePointers() {
+    const unsigned int stride = getVertexSize();
+    int offset = 0;
 
     // Position
     glVertexAttribPointer(0, 3, GL_FLOAT, false, stride, reinterpret_cast<void*>(offset));
@@ -188,45 +641,48 @@ void Mesh::bindBuffers() {
     offset += 3 * sizeof(float);
 
     if((attributes >> 1) & 1) { // Normal
-        glVertexAttribPointer(1, 3, GL_FLOAT, false, stride, reinterpret_cast<void*>(offset));
+        if(quantized) {
+            glVertexAttribPointer(1, 4, GL_INT_2_10_10_10_REV, true, stride, reinterpret_cast<void*>(offset));
+        } else {
+            glVertexAttribPointer(1, 3, GL_FLOAT, false, stride, reinterpret_cast<void*>(offset));
+        }
         glEnableVertexAttribArray(1);
-        offset += 3 * sizeof(float);
+        offset += quantized ? 4 : 3 * sizeof(float);
     }
 
     if((attributes >> 2) & 1) { // Texture Coordinates
-        glVertexAttribPointer(2, 2, GL_FLOAT, false, stride, reinterpret_cast<void*>(offset));
+        if(quantized) {
+            glVertexAttribPointer(2, 2, GL_HALF_FLOAT, false, stride, reinterpret_cast<void*>(offset));
+        } else {
+            glVertexAttribPointer(2, 2, GL_FLOAT, false, stride, reinterpret_cast<void*>(offset));
+        }
         glEnableVertexAttribArray(2);
-        offset += 2 * sizeof(float);
+        offset += quantized ? 4 : 2 * sizeof(float);
     }
 
     if((attributes >> 3) & 1) { // Color
-        glVertexAttribPointer(3, 3, GL_FLOAT, false, stride, reinterpret_cast<void*>(offset));
+        if(quantized) {
+            glVertexAttribPointer(3, 4, GL_UNSIGNED_BYTE, true, stride, reinterpret_cast<void*>(offset));
+        } else {
+            glVertexAttribPointer(3, 3, GL_FLOAT, false, stride, reinterpret_cast<void*>(offset));
+        }
         glEnableVertexAttribArray(3);
-        offset += 3 * sizeof(float);
-    }
-
-    if(!indices.empty()) {
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER,
-                     indices.size() * sizeof(unsigned int),
-                     indices.data(), GL_STATIC_DRAW);
+        offset += quantized ? 4 : 3 * sizeof(float);
     }
 }
 
-unsigned int Mesh::getStride() const {
-    unsigned int stride = 3;
-
-    if((attributes >> 1) & 1) { // Normal
-        stride += 3;
-    }
-
-    if((attributes >> 2) & 1) { // Texture Coordinates
-        stride += 2;
+unsigned int Mesh::getVertexSize() const {
+    if(!quantized) {
+        return getStride() * sizeof(float);
     }
 
-    if((attributes >> 3) & 1) { // Color
-        stride += 3;
-    }
+    // Position: 3 floats ; Normal: 1 packed int ; Texture Coordinates: 2 half floats ; Color: 4 bytes
+    return 3 * sizeof(float)
+           + 4 * ((attributes & NORMAL) != 0)
+           + 4 * ((attributes & TEX_COORDS) != 0)
+           + 4 * ((attributes & COLOR) != 0);
+}
 
-    return stride;
+unsigned int Mesh::getStride() const {
+    return getStride(attributes);
 }
@@ -0,0 +1,256 @@
+/***************************************************************************************************
+ * @file  MeshCache.cpp
+ * @brief Implementation of the MeshCache class
+ **************************************************************************************************/
+
+#include "mesh/MeshCache.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <glad/glad.h>
+
+namespace {
+    constexpr char directory[] = "cache/meshes/"; ///< Where the cached meshes are stored.
+    constexpr uint32_t version = 1;               ///< Incremented whenever the format changes.
+    constexpr uint32_t alignment = 16;            ///< Alignment of the blobs in the file.
+
+    /**
+     * @struct Header
+     * @brief Beginning of a cached mesh file. The levels of detail directly follow it.
+     */
+    struct Header {
+        char magic[4];          ///< Always "MESH".
+        uint32_t version;       ///< The version of the format.
+        uint32_t primitive;     ///< 3D Primitive used to draw.
+        uint8_t attributes;     ///< Bit masks of the attributes, without INSTANCED.
+        uint8_t quantized;      ///< Whether the vertices are quantized.
+        uint16_t padding;       ///< Unused.
+        uint32_t vertexCount;   ///< The amount of vertices.
+        uint32_t indexCount;    ///< The amount of indices.
+        uint32_t indexType;     ///< GL_UNSIGNED_SHORT or GL_UNSIGNED_INT.
+        uint32_t lodCount;      ///< The amount of levels of detail.
+        float low[3];           ///< The lowest corner of the mesh's bounding box.
+        float high[3];          ///< The highest corner of the mesh's bounding box.
+        float generationTime;   ///< The time it took to generate the mesh in milliseconds.
+        uint32_t vertexOffset;  ///< The position of the vertex blob in the file.
+        uint32_t indexOffset;   ///< The position of the index blob in the file.
+    };
+
+    static_assert(std::is_trivially_copyable_v<Header>);
+    static_assert(std::is_trivially_copyable_v<Mesh::LOD>);
+
+    uint32_t align(uint32_t offset) {
+        return (offset + alignment - 1) / alignment * alignment;
+    }
+}
+
+unsigned int MeshCache::hits = 0;
+unsigned int MeshCache::misses = 0;
+float MeshCache::savedTime = 0.0f;
+
+Mesh MeshCache::get(const std::string& key, const std::function<Mesh()>& generate) {
+    const std::string path = directory + key + ".mesh";
+
+    const auto start = std::chrono::steady_clock::now();
+    float generationTime;
+    std::optional<Mesh> cached = load(path, &generationTime);
+
+    if(cached) {
+        const float loadTime = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        ++hits;
+        savedTime += std::max(generationTime - loadTime, 0.0f);
+        cached->setRegenerator(generate);
+        return std::move(*cached);
+    }
+
+    const auto generationStart = std::chrono::steady_clock::now();
+    Mesh mesh = generate();
+    generationTime = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - generationStart).count();
+
+    ++misses;
+
+    // The cache only speeds up the next startups, the mesh is usable even if it can't be stored
+    try {
+        std::filesystem::create_directories(directory);
+        save(mesh, path, generationTime);
+    } catch(const std::exception&) { }
+
+    mesh.setRegenerator(generate);
+    return mesh;
+}
+
+void MeshCache::save(const Mesh& mesh, const std::string& path, float generationTime) {
+    if(mesh.released) {
+        throw std::runtime_error("Mesh data was released and cannot be cached.");
+    }
+
+    const unsigned int stride = mesh.getStride();
+
+    Header header{};
+    std::memcpy(header.magic, "MESH", 4);
+    header.version = version;
+    header.primitive = mesh.primitive;
+    header.attributes = mesh.attributes & ~Mesh::INSTANCED;
+    header.quantized = mesh.quantized;
+    header.vertexCount = mesh.data.size() / stride;
+    header.indexCount = mesh.indices.size();
+    header.lodCount = mesh.lods.size();
+    header.generationTime = generationTime;
+
+    for(int i = 0 ; i < 3 ; ++i) {
+        header.low[i] = header.vertexCount > 0 ? mesh.data[i] : 0.0f;
+        header.high[i] = header.low[i];
+    }
+
+    for(unsigned int i = 0 ; i < header.vertexCount ; ++i) {
+        for(int j = 0 ; j < 3 ; ++j) {
+            header.low[j] = std::min(header.low[j], mesh.data[i * stride + j]);
+            header.high[j] = std::max(header.high[j], mesh.data[i * stride + j]);
+        }
+    }
+
+    std::vector<unsigned char> vertices;
+    if(mesh.quantized) {
+        vertices = mesh.packQuantizedData();
+    } else {
+        vertices.resize(mesh.data.size() * sizeof(float));
+        std::memcpy(vertices.data(), mesh.data.data(), vertices.size());
+    }
+
+    // Same narrowing as when uploading
+    std::vector<unsigned char> indices;
+    if(!mesh.indices.empty() && *std::max_element(mesh.indices.begin(), mesh.indices.end()) <= UINT16_MAX) {
+        const std::vector<uint16_t> shortIndices(mesh.indices.begin(), mesh.indices.end());
+
+        header.indexType = GL_UNSIGNED_SHORT;
+        indices.resize(shortIndices.size() * sizeof(uint16_t));
+        std::memcpy(indices.data(), shortIndices.data(), indices.size());
+    } else {
+        header.indexType = GL_UNSIGNED_INT;
+        indices.resize(mesh.indices.size() * sizeof(unsigned int));
+        std::memcpy(indices.data(), mesh.indices.data(), indices.size());
+    }
+
+    header.vertexOffset = align(sizeof(Header) + header.lodCount * sizeof(Mesh::LOD));
+    header.indexOffset = align(header.vertexOffset + vertices.size());
+
+    std::vector<unsigned char> file(header.indexOffset + indices.size(), 0);
+    std::memcpy(file.data(), &header, sizeof(Header));
+    if(!mesh.lods.empty()) {
+        std::memcpy(file.data() + sizeof(Header), mesh.lods.data(), mesh.lods.size() * sizeof(Mesh::LOD));
+    }
+    std::memcpy(file.data() + header.vertexOffset, vertices.data(), vertices.size());
+    std::memcpy(file.data() + header.indexOffset, indices.data(), indices.size());
+
+    // Written next to the destination then renamed so that a partial file is never loaded
+    const std::string temporary = path + ".tmp";
+    std::ofstream stream(temporary, std::ios::binary | std::ios::trunc);
+    stream.write(reinterpret_cast<const char*>(file.data()), file.size());
+    stream.close();
+
+    if(!stream) {
+        throw std::runtime_error("Failed to write the cached mesh " + path + ".");
+    }
+
+    std::filesystem::rename(temporary, path);
+}
+
+std::optional<Mesh> MeshCache::load(const std::string& path, float* generationTime) {
+    const int file = open(path.c_str(), O_RDONLY);
+    if(file < 0) {
+        return std::nullopt;
+    }
+
+    struct stat status;
+    if(fstat(file, &status) != 0 || static_cast<size_t>(status.st_size) < sizeof(Header)) {
+        close(file);
+        return std::nullopt;
+    }
+
+    const size_t size = status.st_size;
+    void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+    close(file);
+
+    if(mapping == MAP_FAILED) {
+        return std::nullopt;
+    }
+
+    const unsigned char* bytes = static_cast<const unsigned char*>(mapping);
+
+    Header header;
+    std::memcpy(&header, bytes, sizeof(Header));
+
+    if(std::memcmp(header.magic, "MESH", 4) != 0 || header.version != version) {
+        munmap(mapping, size);
+        return std::nullopt;
+    }
+
+    Mesh mesh(header.primitive, header.attributes);
+    mesh.quantized = header.quantized;
+
+    const size_t vertexBytes = static_cast<size_t>(header.vertexCount) * mesh.getVertexSize();
+    const size_t indexBytes = static_cast<size_t>(header.indexCount)
+                              * (header.indexType == GL_UNSIGNED_SHORT ? sizeof(uint16_t) : sizeof(unsigned int));
+
+    if(sizeof(Header) + static_cast<size_t>(header.lodCount) * sizeof(Mesh::LOD) > header.vertexOffset
+       || header.vertexOffset + vertexBytes > header.indexOffset
+       || header.indexOffset + indexBytes > size) {
+        munmap(mapping, size);
+        return std::nullopt;
+    }
+
+    mesh.lods.resize(header.lodCount);
+    std::memcpy(mesh.lods.data(), bytes + sizeof(Header), header.lodCount * sizeof(Mesh::LOD));
+
+    // The blobs are already in the uploaded format, they go from the mapping to the GPU untouched
+    glBindVertexArray(mesh.VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, mesh.VBO);
+    glBufferData(GL_ARRAY_BUFFER, vertexBytes, bytes + header.vertexOffset, GL_STATIC_DRAW);
+    mesh.setAttributePointers();
+
+    if(header.indexCount > 0) {
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.EBO);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexBytes, bytes + header.indexOffset, GL_STATIC_DRAW);
+    }
+
+    munmap(mapping, size);
+
+    mesh.vertexCount = header.vertexCount;
+    mesh.indexCount = header.indexCount;
+    mesh.indexType = header.indexType;
+    mesh.gpuSize = vertexBytes + indexBytes;
+    mesh.savedGPUSize = (header.vertexCount * mesh.getStride() + header.indexCount) * 4 - mesh.gpuSize;
+    mesh.shouldBind = false;
+    mesh.released = true;
+    mesh.retention = Mesh::RELEASE;
+
+    if(generationTime) {
+        *generationTime = header.generationTime;
+    }
+
+    return mesh;
+}
+
+unsigned int MeshCache::getHits() {
+    return hits;
+}
+
+unsigned int MeshCache::getMisses() {
+    return misses;
+}
+
+float MeshCache::getSavedTime() {
+    return savedTime;
+}
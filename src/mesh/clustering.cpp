@@ -0,0 +1,228 @@
+/***************************************************************************************************
+ * @file  clustering.cpp
+ * @brief Implementation of functions to split meshes in clusters that can be culled separately
+ **************************************************************************************************/
+
+#include "mesh/clustering.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <numeric>
+#include <glm/geometric.hpp>
+
+namespace {
+    constexpr unsigned int maxCandidates = 32; ///< Amount of recent candidates compared when growing a cluster.
+}
+
+std::vector<Clustering::Cluster> Clustering::build(std::span<const float> data, std::vector<unsigned int>& indices,
+                                                   unsigned int stride, unsigned int maxTriangles,
+                                                   unsigned int maxVertices) {
+    const unsigned int vertexCount = data.size() / stride;
+    const unsigned int triangleCount = indices.size() / 3;
+
+    auto getPosition = [&](unsigned int vertex) {
+        return vec3(data[vertex * stride], data[vertex * stride + 1], data[vertex * stride + 2]);
+    };
+
+    /**** Adjacency ****/
+    // The triangles using each vertex, stored contiguously
+    std::vector<unsigned int> offsets(vertexCount + 1, 0);
+    for(unsigned int index: indices) {
+        ++offsets[index + 1];
+    }
+    std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+    std::vector<unsigned int> adjacency(indices.size());
+    std::vector<unsigned int> fill(offsets.begin(), offsets.end() - 1);
+    for(unsigned int i = 0 ; i < indices.size() ; ++i) {
+        adjacency[fill[indices[i]]++] = i / 3;
+    }
+
+    /**** Clusters ****/
+    std::vector<Cluster> clusters;
+    std::vector<unsigned int> result;
+    result.reserve(indices.size());
+
+    std::vector<bool> added(triangleCount, false);
+    std::vector<unsigned int> lastCluster(vertexCount, UINT_MAX); // The last cluster using each vertex
+    std::vector<unsigned int> candidates;
+    std::vector<unsigned int> vertices;
+    unsigned int seed = 0;
+
+    while(true) {
+        while(seed < triangleCount && added[seed]) {
+            ++seed;
+        }
+
+        if(seed == triangleCount) {
+            break;
+        }
+
+        const unsigned int id = clusters.size();
+        const unsigned int firstIndex = result.size();
+        unsigned int next = seed;
+
+        candidates.clear();
+        vertices.clear();
+        vec3 sum(0.0f); // Sum of the cluster's vertices' positions
+
+        auto countNewVertices = [&](unsigned int triangle) {
+            return (lastCluster[indices[3 * triangle]] != id)
+                   + (lastCluster[indices[3 * triangle + 1]] != id)
+                   + (lastCluster[indices[3 * triangle + 2]] != id);
+        };
+
+        // The cluster grows with the neighbouring triangle adding the fewest vertices
+        while(true) {
+            added[next] = true;
+
+            for(int i = 0 ; i < 3 ; ++i) {
+                const unsigned int vertex = indices[3 * next + i];
+                result.push_back(vertex);
+
+                if(lastCluster[vertex] != id) {
+                    lastCluster[vertex] = id;
+                    vertices.push_back(vertex);
+                    sum += getPosition(vertex);
+                }
+
+                for(unsigned int j = offsets[vertex] ; j < offsets[vertex + 1] ; ++j) {
+                    if(!added[adjacency[j]]) {
+                        candidates.push_back(adjacency[j]);
+                    }
+                }
+            }
+
+            if(result.size() - firstIndex >= 3 * maxTriangles) {
+                break;
+            }
+
+            // Ties are broken by the distance to the cluster's center to keep it compact
+            const vec3 center = sum / static_cast<float>(vertices.size());
+            auto getDistance = [&](unsigned int triangle) {
+                return distance(center, getPosition(indices[3 * triangle]))
+                       + distance(center, getPosition(indices[3 * triangle + 1]))
+                       + distance(center, getPosition(indices[3 * triangle + 2]));
+            };
+
+            unsigned int best = UINT_MAX;
+            unsigned int bestNewVertices = 4;
+            float bestDistance = 0.0f;
+            unsigned int compared = 0;
+
+            for(unsigned int i = candidates.size() ; i-- > 0 && compared < maxCandidates ; ) {
+                const unsigned int candidate = candidates[i];
+
+                if(added[candidate]) {
+                    candidates[i] = candidates.back();
+                    candidates.pop_back();
+                    continue;
+                }
+
+                ++compared;
+                const unsigned int newVertices = countNewVertices(candidate);
+                if(newVertices > bestNewVertices) {
+                    continue;
+                }
+
+                const float candidateDistance = getDistance(candidate);
+                if(newVertices < bestNewVertices || candidateDistance < bestDistance) {
+                    best = candidate;
+                    bestNewVertices = newVertices;
+                    bestDistance = candidateDistance;
+                }
+            }
+
+            if(best == UINT_MAX || vertices.size() + bestNewVertices > maxVertices) {
+                break;
+            }
+
+            next = best;
+        }
+
+        /**** Bounds ****/
+        Cluster cluster{firstIndex, static_cast<unsigned int>(result.size() - firstIndex), vec3(), 0.0f, vec3(), 1.0f};
+
+        vec3 low = getPosition(vertices[0]);
+        vec3 high = low;
+        for(unsigned int vertex: vertices) {
+            low = min(low, getPosition(vertex));
+            high = max(high, getPosition(vertex));
+        }
+
+        cluster.center = (low + high) / 2.0f;
+        for(unsigned int vertex: vertices) {
+            cluster.radius = std::max(cluster.radius, distance(cluster.center, getPosition(vertex)));
+        }
+
+        // The cone contains all the triangles' normals
+        std::vector<vec3> normals;
+        normals.reserve(cluster.indexCount / 3);
+        vec3 axis(0.0f);
+
+        for(unsigned int i = firstIndex ; i < result.size() ; i += 3) {
+            const vec3 a = getPosition(result[i]);
+            const vec3 normal = cross(getPosition(result[i + 1]) - a, getPosition(result[i + 2]) - a);
+
+            if(length(normal) > 0.0f) {
+                normals.push_back(normalize(normal));
+                axis += normals.back();
+            }
+        }
+
+        if(length(axis) > 0.0f) {
+            cluster.coneAxis = normalize(axis);
+
+            float minDot = 1.0f;
+            for(const vec3& normal: normals) {
+                minDot = std::min(minDot, dot(normal, cluster.coneAxis));
+            }
+
+            if(minDot > 0.0f) {
+                cluster.coneCutoff = std::sqrt(1.0f - minDot * minDot);
+            }
+        }
+
+        clusters.push_back(cluster);
+    }
+
+    indices = std::move(result);
+    return clusters;
+}
+
+bool Clustering::isBackfacing(const Cluster& cluster, const vec3& cameraPos) {
+    if(cluster.coneCutoff >= 1.0f) {
+        return false;
+    }
+
+    // Every point of the bounding sphere must be seen from behind by every normal of the cone
+    const vec3 toCluster = cluster.center - cameraPos;
+
+    return dot(toCluster, cluster.coneAxis)
+           > cluster.coneCutoff * length(toCluster) + cluster.radius * (1.0f + cluster.coneCutoff);
+}
+
+void Clustering::cull(std::span<const Cluster> clusters, const Frustum& frustum, const vec3& cameraPos,
+                      std::vector<unsigned int>& visible, CullingStats* stats) {
+    visible.clear();
+    CullingStats counts;
+
+    for(unsigned int i = 0 ; i < clusters.size() ; ++i) {
+        const Cluster& cluster = clusters[i];
+        const unsigned int triangles = cluster.indexCount / 3;
+
+        if(!frustum.intersects(cluster.center, cluster.radius)) {
+            counts.frustumRejected += triangles;
+        } else if(isBackfacing(cluster, cameraPos)) {
+            counts.coneRejected += triangles;
+        } else {
+            counts.accepted += triangles;
+            visible.push_back(i);
+        }
+    }
+
+    if(stats) {
+        *stats = counts;
+    }
+}
@@ -0,0 +1,70 @@
+/***************************************************************************************************
+ * @file  handles.cpp
+ * @brief Implementation of the VertexArray and Buffer classes
+ **************************************************************************************************/
+
+#include "mesh/handles.hpp"
+
+#include <utility>
+#include <glad/glad.h>
+
+unsigned int VertexArray::createdCount = 0;
+unsigned int Buffer::createdCount = 0;
+
+VertexArray::VertexArray() {
+    glGenVertexArrays(1, &id);
+    ++createdCount;
+}
+
+VertexArray::VertexArray(VertexArray&& vertexArray) noexcept
+    : id(std::exchange(vertexArray.id, 0)) { }
+
+VertexArray& VertexArray::operator =(VertexArray&& vertexArray) noexcept {
+    if(&vertexArray != this) {
+        glDeleteVertexArrays(1, &id);
+        id = std::exchange(vertexArray.id, 0);
+    }
+
+    return *this;
+}
+
+VertexArray::~VertexArray() {
+    glDeleteVertexArrays(1, &id);
+}
+
+VertexArray::operator unsigned int() const {
+    return id;
+}
+
+unsigned int VertexArray::getCreatedCount() {
+    return createdCount;
+}
+
+Buffer::Buffer() {
+    glGenBuffers(1, &id);
+    ++createdCount;
+}
+
+Buffer::Buffer(Buffer&& buffer) noexcept
+    : id(std::exchange(buffer.id, 0)) { }
+
+Buffer& Buffer::operator =(Buffer&& buffer) noexcept {
+    if(&buffer != this) {
+        glDeleteBuffers(1, &id);
+        id = std::exchange(buffer.id, 0);
+    }
+
+    return *this;
+}
+
+Buffer::~Buffer() {
+    glDeleteBuffers(1, &id);
+}
+
+Buffer::operator unsigned int() const {
+    return id;
+}
+
+unsigned int Buffer::getCreatedCount() {
+    return createdCount;
+}
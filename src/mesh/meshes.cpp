@@ -6,10 +6,14 @@
 #include "mesh/meshes.hpp"
 
 #include <cmath>
+#include <utility>
+
+#include "mesh/TypedMesh.hpp"
 #include <glad/glad.h>
 
 Mesh Meshes::cube() {
-    Mesh mesh(GL_TRIANGLES);
+    Mesh mesh(GL_TRIANGLES, Mesh::NORMAL | Mesh::TEX_COORDS);
+    mesh.reserve(24, 36);
 
     /* Vertices' index
      *  0───1
@@ -85,7 +89,8 @@ Mesh Meshes::cube() {
 }
 
 Mesh Meshes::texturedCube() {
-    Mesh mesh(GL_TRIANGLES);
+    Mesh mesh(GL_TRIANGLES, Mesh::NORMAL | Mesh::TEX_COORDS);
+    mesh.reserve(24, 36);
 
     /* Vertices' index
      *  0───1
@@ -174,6 +179,7 @@ Mesh Meshes::texturedCube() {
 
 Mesh Meshes::wireframeCube() {
     Mesh mesh(GL_LINES);
+    mesh.reserve(8, 24);
 
     mesh.addPosition(-0.5f, 0.5f, -0.5f);
     mesh.addPosition(0.5f, 0.5f, -0.5f);
@@ -217,7 +223,8 @@ Mesh Meshes::wireframeCube() {
 }
 
 Mesh Meshes::plainCube() {
-    Mesh mesh(GL_TRIANGLES);
+    Mesh mesh(GL_TRIANGLES, Mesh::TEX_COORDS);
+    mesh.reserve(24, 36);
 
     /* Vertices' index
      *  0───1
@@ -281,6 +288,7 @@ Mesh Meshes::plainCube() {
 
 Mesh Meshes::cubemap() {
     Mesh mesh(GL_TRIANGLES);
+    mesh.reserve(24, 36);
 
     /* Vertices' index
      *  0───1
@@ -337,6 +345,7 @@ Mesh Meshes::cubemap() {
 
 Mesh Meshes::grid(float size, int divisions) {
     Mesh mesh(GL_LINES);
+    mesh.reserve(4 * (divisions + 1), 0);
 
     float square = -size / 2.0f;
     const float squareSize = size / divisions;
@@ -355,22 +364,19 @@ Mesh Meshes::grid(float size, int divisions) {
 }
 
 Mesh Meshes::planeGrid(float size, int divisions) {
-    Mesh mesh(GL_TRIANGLES);
+    TypedMesh<Attributes::Position, Attributes::Normal> mesh(GL_TRIANGLES);
+    mesh.reserve((divisions + 1) * (divisions + 1), 6 * divisions * divisions);
 
     const float halfSize = -size / 2.0f;
     const float squareSize = size / divisions;
-    float squareX = halfSize, squareZ = halfSize;
 
     for(int i = 0 ; i <= divisions ; ++i) {
         for(int j = 0 ; j <= divisions ; ++j) {
-            mesh.addPosition(squareX, 0.0f, squareZ);
-            mesh.addNormal(0.0f, 1.0f, 0.0f);
-
-            squareX += squareSize;
+            mesh.addVertex({
+                vec3(halfSize + j * squareSize, 0.0f, halfSize + i * squareSize),
+                vec3(0.0f, 1.0f, 0.0f)
+            });
         }
-
-        squareX = halfSize;
-        squareZ += squareSize;
     }
 
     auto index = [&](int x, int y) -> int {
@@ -386,11 +392,12 @@ Mesh Meshes::planeGrid(float size, int divisions) {
         }
     }
 
-    return mesh;
+    return std::move(mesh).toMesh();
 }
 
 Mesh Meshes::axes(float size) {
-    Mesh mesh(GL_LINES);
+    Mesh mesh(GL_LINES, Mesh::COLOR);
+    mesh.reserve(6, 0);
 
     const vec3 axes[3]{
         {1.0f, 0.0f, 0.0f},
@@ -410,7 +417,8 @@ Mesh Meshes::axes(float size) {
 }
 
 Mesh Meshes::sphere(int divTheta, int divPhi) {
-    Mesh mesh(GL_TRIANGLES);
+    TypedMesh<Attributes::Position, Attributes::Normal> mesh(GL_TRIANGLES);
+    mesh.reserve((divTheta - 1) * divPhi + 2, 6 * (divTheta - 1) * divPhi);
 
     const double thetaStep = M_PI / divTheta;
     const double phiStep = 2.0f * M_PI / divPhi;
@@ -427,8 +435,7 @@ Mesh Meshes::sphere(int divTheta, int divPhi) {
             point.y = sin(theta);
             point.z = cos(theta) * sin(phi);
 
-            mesh.addPosition(point);
-            mesh.addNormal(point);
+            mesh.addVertex({point, point});
 
             phi += phiStep;
         }
@@ -451,11 +458,8 @@ Mesh Meshes::sphere(int divTheta, int divPhi) {
         }
     }
 
-    mesh.addPosition(0.0f, -1.0f, 0.0f);
-    mesh.addNormal(0.0f, -1.0f, 0.0f);
-
-    mesh.addPosition(0.0f, 1.0f, 0.0f);
-    mesh.addNormal(0.0f, 1.0f, 0.0f);
+    mesh.addVertex({vec3(0.0f, -1.0f, 0.0f), vec3(0.0f, -1.0f, 0.0f)});
+    mesh.addVertex({vec3(0.0f, 1.0f, 0.0f), vec3(0.0f, 1.0f, 0.0f)});
 
     for(int i = 0 ; i < divPhi ; ++i) {
         mesh.addTriangle(
@@ -471,11 +475,12 @@ Mesh Meshes::sphere(int divTheta, int divPhi) {
         );
     }
 
-    return mesh;
+    return std::move(mesh).toMesh();
 }
 
 Mesh Meshes::texturedSphere(int divTheta, int divPhi) {
-    Mesh mesh(GL_TRIANGLES);
+    TypedMesh<Attributes::Position, Attributes::Normal, Attributes::TexCoords> mesh(GL_TRIANGLES);
+    mesh.reserve(divTheta * (divPhi + 1), 6 * (divTheta - 1) * divPhi);
 
     const double thetaStep = M_PI / divTheta;
     const double phiStep = 2.0 * M_PI / divPhi;
@@ -492,9 +497,7 @@ Mesh Meshes::texturedSphere(int divTheta, int divPhi) {
             point.y = sin(theta);
             point.z = cos(theta) * sin(phi);
 
-            mesh.addPosition(point);
-            mesh.addNormal(point);
-            mesh.addTexCoord(static_cast<float>(j) / divPhi, 0.5 + point.y / 2.0);
+            mesh.addVertex({point, point, vec2(static_cast<float>(j) / divPhi, 0.5f + point.y / 2.0f)});
 
             phi += phiStep;
         }
@@ -517,11 +520,12 @@ Mesh Meshes::texturedSphere(int divTheta, int divPhi) {
         }
     }
 
-    return mesh;
+    return std::move(mesh).toMesh();
 }
 
 Mesh Meshes::plane(float size) {
-    Mesh mesh(GL_TRIANGLES);
+    Mesh mesh(GL_TRIANGLES, Mesh::TEX_COORDS);
+    mesh.reserve(4, 6);
 
     size /= 2;
 
@@ -544,6 +548,7 @@ Mesh Meshes::plane(float size) {
 
 Mesh Meshes::chunk() {
     Mesh mesh(GL_PATCHES);
+    mesh.reserve(4, 0);
 
     mesh.addPosition(-0.5f, 0.0f, 0.5f);
     mesh.addPosition(0.5f, 0.0f, 0.5f);
@@ -554,21 +559,16 @@ Mesh Meshes::chunk() {
 }
 
 Mesh Meshes::tessGrid(float size, int divisions) {
-    Mesh mesh(GL_PATCHES);
+    TypedMesh<Attributes::Position> mesh(GL_PATCHES);
+    mesh.reserve((divisions + 1) * (divisions + 1), 4 * divisions * divisions);
 
     const float halfSize = -size / 2.0f;
     const float squareSize = size / divisions;
-    float squareX = halfSize, squareZ = halfSize;
 
     for(int i = 0 ; i <= divisions ; ++i) {
         for(int j = 0 ; j <= divisions ; ++j) {
-            mesh.addPosition(squareX, 0.0f, squareZ);
-
-            squareX += squareSize;
+            mesh.addVertex({vec3(halfSize + j * squareSize, 0.0f, halfSize + i * squareSize)});
         }
-
-        squareX = halfSize;
-        squareZ += squareSize;
     }
 
     auto index = [&](int x, int y) -> int {
@@ -584,11 +584,12 @@ Mesh Meshes::tessGrid(float size, int divisions) {
         }
     }
 
-    return mesh;
+    return std::move(mesh).toMesh();
 }
 
 Mesh Meshes::nplane(float size) {
-    Mesh mesh(GL_TRIANGLES);
+    Mesh mesh(GL_TRIANGLES, Mesh::NORMAL | Mesh::TEX_COORDS);
+    mesh.reserve(4, 6);
 
     size /= 2;
 
@@ -615,6 +616,7 @@ Mesh Meshes::nplane(float size) {
 
 Mesh Meshes::screen() {
     Mesh mesh(GL_TRIANGLES);
+    mesh.reserve(4, 6);
 
     mesh.addPosition(-1.0f, 1.0f, 0.0f);
     mesh.addPosition(-1.0f, -1.0f, 0.0f);
@@ -625,3 +627,33 @@ Mesh Meshes::screen() {
 
     return mesh;
 }
+
+Mesh Meshes::grassTuft() {
+    Mesh mesh(GL_TRIANGLES, Mesh::NORMAL);
+    mesh.reserve(12, 36);
+
+    constexpr float halfWidth = 0.3f;
+
+    for(int i = 0 ; i < 3 ; ++i) {
+        const float angle = i * M_PIf / 3.0f;
+        const vec3 side(halfWidth * cosf(angle), 0.0f, halfWidth * sinf(angle));
+
+        mesh.addPosition(-side.x, 1.0f, -side.z);
+        mesh.addNormal(0.0f, 1.0f, 0.0f);
+
+        mesh.addPosition(-side);
+        mesh.addNormal(0.0f, 1.0f, 0.0f);
+
+        mesh.addPosition(side);
+        mesh.addNormal(0.0f, 1.0f, 0.0f);
+
+        mesh.addPosition(side.x, 1.0f, side.z);
+        mesh.addNormal(0.0f, 1.0f, 0.0f);
+
+        // Front and back faces
+        mesh.addFace((i * 4), (i * 4) + 1, (i * 4) + 2, (i * 4) + 3);
+        mesh.addFace((i * 4) + 3, (i * 4) + 2, (i * 4) + 1, (i * 4));
+    }
+
+    return mesh;
+}
@@ -0,0 +1,205 @@
+/***************************************************************************************************
+ * @file  optimization.cpp
+ * @brief Implementation of functions to optimize the order of a mesh's vertices and indices
+ **************************************************************************************************/
+
+#include "mesh/optimization.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <numeric>
+
+namespace {
+    constexpr int cacheSize = 32;    ///< Size of the cache modelled by the scores.
+    constexpr int maxValence = 32;   ///< Valences above it all get the same score.
+
+    /**
+     * @struct ScoreTables
+     * @brief Precomputed parts of the vertices' scores. The constants are the ones suggested by
+     * Tom Forsyth.
+     */
+    struct ScoreTables {
+        ScoreTables() {
+            for(int i = 0 ; i < cacheSize ; ++i) {
+                // The last triangle's vertices get a fixed score so that strips aren't favored
+                cache[i] = i < 3 ? 0.75f : std::pow(1.0f - (i - 3) / static_cast<float>(cacheSize - 3), 1.5f);
+            }
+
+            // Vertices with few remaining triangles are favored so that they leave the mesh early
+            valence[0] = -1.0f;
+            for(int i = 1 ; i <= maxValence ; ++i) {
+                valence[i] = 2.0f / std::sqrt(static_cast<float>(i));
+            }
+        }
+
+        float cache[cacheSize];        ///< Score of each position in the cache.
+        float valence[maxValence + 1]; ///< Score of each amount of remaining triangles.
+    };
+
+    /**
+     * @brief Scores a vertex according to its position in the cache and the amount of triangles
+     * using it that remain to be added.
+     * @param cachePosition The position of the vertex in the cache, -1 if it isn't in it.
+     * @param valence The amount of remaining triangles using the vertex.
+     * @return The vertex's score, -1 if it isn't used anymore.
+     */
+    float getVertexScore(int cachePosition, unsigned int valence) {
+        static const ScoreTables tables;
+
+        if(valence == 0) {
+            return -1.0f;
+        }
+
+        return (cachePosition >= 0 ? tables.cache[cachePosition] : 0.0f)
+               + tables.valence[std::min<unsigned int>(valence, maxValence)];
+    }
+}
+
+void Optimization::optimizeVertexCache(std::vector<unsigned int>& indices, unsigned int vertexCount) {
+    const unsigned int triangleCount = indices.size() / 3;
+
+    /**** Adjacency ****/
+    // The triangles using each vertex, stored contiguously
+    std::vector<unsigned int> offsets(vertexCount + 1, 0);
+    for(unsigned int index: indices) {
+        ++offsets[index + 1];
+    }
+    std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+    std::vector<unsigned int> valences(vertexCount, 0);
+    std::vector<unsigned int> adjacency(indices.size());
+    for(unsigned int i = 0 ; i < indices.size() ; ++i) {
+        const unsigned int vertex = indices[i];
+        adjacency[offsets[vertex] + valences[vertex]++] = i / 3;
+    }
+
+    /**** Scores ****/
+    std::vector<int> cachePositions(vertexCount, -1);
+    std::vector<float> vertexScores(vertexCount);
+    for(unsigned int i = 0 ; i < vertexCount ; ++i) {
+        vertexScores[i] = getVertexScore(-1, valences[i]);
+    }
+
+    auto getTriangleScore = [&](unsigned int triangle) {
+        return vertexScores[indices[3 * triangle]]
+               + vertexScores[indices[3 * triangle + 1]]
+               + vertexScores[indices[3 * triangle + 2]];
+    };
+
+    std::vector<bool> added(triangleCount, false);
+    std::vector<unsigned int> result;
+    result.reserve(indices.size());
+
+    std::vector<unsigned int> cache;
+    std::vector<unsigned int> newCache;
+    cache.reserve(cacheSize + 3);
+    newCache.reserve(cacheSize + 3);
+
+    unsigned int cursor = 0; // Every triangle before it was added
+    int best = -1;
+
+    while(result.size() < 3 * triangleCount) {
+        // When no triangle touches the cache, the next one in the original order is taken
+        if(best < 0) {
+            while(added[cursor]) {
+                ++cursor;
+            }
+            best = cursor;
+        }
+
+        added[best] = true;
+        const unsigned int* triangle = &indices[3 * best];
+        result.insert(result.end(), triangle, triangle + 3);
+
+        // The triangle is removed from its vertices' adjacency
+        for(int i = 0 ; i < 3 ; ++i) {
+            const unsigned int vertex = triangle[i];
+            unsigned int* first = &adjacency[offsets[vertex]];
+            unsigned int* last = first + valences[vertex] - 1;
+
+            std::iter_swap(std::find(first, last, static_cast<unsigned int>(best)), last);
+            --valences[vertex];
+        }
+
+        // The triangle's vertices move at the front of the cache
+        newCache.assign(triangle, triangle + 3);
+        for(unsigned int vertex: cache) {
+            if(vertex != triangle[0] && vertex != triangle[1] && vertex != triangle[2]) {
+                newCache.push_back(vertex);
+            }
+        }
+
+        for(unsigned int i = 0 ; i < newCache.size() ; ++i) {
+            const unsigned int vertex = newCache[i];
+            cachePositions[vertex] = i < cacheSize ? i : -1;
+            vertexScores[vertex] = getVertexScore(cachePositions[vertex], valences[vertex]);
+        }
+
+        // Only the triangles using the updated vertices changed score, the best one is among them
+        best = -1;
+        float bestScore = 0.0f;
+        for(unsigned int vertex: newCache) {
+            for(unsigned int i = offsets[vertex] ; i < offsets[vertex] + valences[vertex] ; ++i) {
+                const unsigned int candidate = adjacency[i];
+                const float score = getTriangleScore(candidate);
+
+                if(score > bestScore) {
+                    best = candidate;
+                    bestScore = score;
+                }
+            }
+        }
+
+        newCache.resize(std::min<unsigned int>(newCache.size(), cacheSize));
+        std::swap(cache, newCache);
+    }
+
+    indices = std::move(result);
+}
+
+void Optimization::optimizeVertexFetch(std::vector<float>& data, std::vector<unsigned int>& indices, unsigned int stride) {
+    const unsigned int vertexCount = data.size() / stride;
+
+    std::vector<unsigned int> remap(vertexCount, UINT_MAX);
+    std::vector<float> result;
+    result.reserve(data.size());
+
+    unsigned int next = 0;
+    for(unsigned int& index: indices) {
+        if(remap[index] == UINT_MAX) {
+            remap[index] = next++;
+            result.insert(result.end(), &data[index * stride], &data[(index + 1) * stride]);
+        }
+
+        index = remap[index];
+    }
+
+    for(unsigned int i = 0 ; i < vertexCount ; ++i) {
+        if(remap[i] == UINT_MAX) {
+            result.insert(result.end(), &data[i * stride], &data[(i + 1) * stride]);
+        }
+    }
+
+    data = std::move(result);
+}
+
+float Optimization::getACMR(std::span<const unsigned int> indices, unsigned int vertexCount, unsigned int cacheSize) {
+    if(indices.size() < 3) {
+        return 0.0f;
+    }
+
+    // A vertex is in the cache if fewer than cacheSize vertices were transformed since it was
+    std::vector<unsigned int> timestamps(vertexCount, 0);
+    unsigned int time = cacheSize + 1;
+    unsigned int misses = 0;
+
+    for(unsigned int index: indices) {
+        if(time - timestamps[index] > cacheSize) {
+            timestamps[index] = time++;
+            ++misses;
+        }
+    }
+
+    return static_cast<float>(misses) / static_cast<float>(indices.size() / 3);
+}
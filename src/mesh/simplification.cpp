@@ -0,0 +1,284 @@
+/***************************************************************************************************
+ * @file  simplification.cpp
+ * @brief Implementation of functions to simplify meshes with quadric error metrics
+ **************************************************************************************************/
+
+#include "mesh/simplification.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <numeric>
+#include <unordered_map>
+#include <glm/vec3.hpp>
+#include <glm/geometric.hpp>
+
+using namespace glm;
+
+namespace {
+    /**
+     * @struct Quadric
+     * @brief Weighted sum of the squared distances to a set of planes, stored as the upper half of
+     * a symmetric 4x4 matrix along with the total weight.
+     */
+    struct Quadric {
+        double xx = 0.0, xy = 0.0, xz = 0.0, xw = 0.0;
+        double yy = 0.0, yz = 0.0, yw = 0.0;
+        double zz = 0.0, zw = 0.0;
+        double ww = 0.0;
+        double weight = 0.0;
+
+        /**
+         * @brief Adds a plane to the quadric.
+         * @param normal The unit normal of the plane.
+         * @param distance The plane's offset, such that dot(normal, p) + distance = 0 on it.
+         * @param weight The weight of the plane, e.g. the area of the triangle it comes from.
+         */
+        void addPlane(const dvec3& normal, double distance, double weight) {
+            xx += weight * normal.x * normal.x;
+            xy += weight * normal.x * normal.y;
+            xz += weight * normal.x * normal.z;
+            xw += weight * normal.x * distance;
+            yy += weight * normal.y * normal.y;
+            yz += weight * normal.y * normal.z;
+            yw += weight * normal.y * distance;
+            zz += weight * normal.z * normal.z;
+            zw += weight * normal.z * distance;
+            ww += weight * distance * distance;
+            this->weight += weight;
+        }
+
+        /**
+         * @brief Adds the planes of another quadric.
+         * @param quadric The other quadric.
+         */
+        void add(const Quadric& quadric) {
+            xx += quadric.xx; xy += quadric.xy; xz += quadric.xz; xw += quadric.xw;
+            yy += quadric.yy; yz += quadric.yz; yw += quadric.yw;
+            zz += quadric.zz; zw += quadric.zw;
+            ww += quadric.ww;
+            weight += quadric.weight;
+        }
+
+        /**
+         * @brief Calculates the weighted mean of the squared distances from a point to the planes.
+         * @param p The point.
+         * @return The error of the point.
+         */
+        double evaluate(const dvec3& p) const {
+            if(weight == 0.0) {
+                return 0.0;
+            }
+
+            return (xx * p.x * p.x + 2.0 * xy * p.x * p.y + 2.0 * xz * p.x * p.z + 2.0 * xw * p.x
+                   + yy * p.y * p.y + 2.0 * yz * p.y * p.z + 2.0 * yw * p.y
+                   + zz * p.z * p.z + 2.0 * zw * p.z
+                   + ww) / weight;
+        }
+    };
+
+    /**
+     * @struct Collapse
+     * @brief Moving a vertex onto one of its neighbours.
+     */
+    struct Collapse {
+        unsigned int from; ///< The vertex that disappears.
+        unsigned int to;   ///< The vertex it is merged into.
+        double cost;       ///< The quadric error of the merged vertex.
+    };
+
+    /**
+     * @brief Packs an undirected edge in a single key.
+     * @param a, b The edge's vertices.
+     * @return The key corresponding to the edge.
+     */
+    uint64_t edgeKey(unsigned int a, unsigned int b) {
+        return static_cast<uint64_t>(std::min(a, b)) << 32 | std::max(a, b);
+    }
+}
+
+std::vector<unsigned int> Simplification::simplify(std::span<const float> data, std::span<const unsigned int> indices,
+                                                   unsigned int stride, unsigned int targetTriangles, float maxError,
+                                                   float* error) {
+    const unsigned int vertexCount = data.size() / stride;
+
+    std::vector<dvec3> positions(vertexCount);
+    for(unsigned int i = 0 ; i < vertexCount ; ++i) {
+        positions[i] = dvec3(data[i * stride], data[i * stride + 1], data[i * stride + 2]);
+    }
+
+    /**** Locked Vertices ****/
+    std::vector<bool> locked(vertexCount, false);
+
+    // Border edges belong to a single triangle
+    std::unordered_map<uint64_t, unsigned int> edges;
+    for(unsigned int i = 0 ; i < indices.size() ; i += 3) {
+        for(int j = 0 ; j < 3 ; ++j) {
+            ++edges[edgeKey(indices[i + j], indices[i + (j + 1) % 3])];
+        }
+    }
+
+    for(const auto& [key, count]: edges) {
+        if(count == 1) {
+            locked[key >> 32] = true;
+            locked[key & UINT32_MAX] = true;
+        }
+    }
+
+    // Vertices sharing a position differ by other attributes, moving one would open a crack
+    std::vector<unsigned int> sorted(vertexCount);
+    std::iota(sorted.begin(), sorted.end(), 0u);
+    std::sort(sorted.begin(), sorted.end(), [&](unsigned int a, unsigned int b) {
+        return std::lexicographical_compare(&positions[a].x, &positions[a].x + 3, &positions[b].x, &positions[b].x + 3);
+    });
+
+    for(unsigned int i = 1 ; i < vertexCount ; ++i) {
+        if(positions[sorted[i]] == positions[sorted[i - 1]]) {
+            locked[sorted[i]] = true;
+            locked[sorted[i - 1]] = true;
+        }
+    }
+
+    /**** Quadrics ****/
+    std::vector<Quadric> quadrics(vertexCount);
+    for(unsigned int i = 0 ; i < indices.size() ; i += 3) {
+        const dvec3& a = positions[indices[i]];
+        const dvec3 normal = cross(positions[indices[i + 1]] - a, positions[indices[i + 2]] - a);
+        const double area = length(normal);
+
+        if(area > 0.0) {
+            Quadric quadric;
+            quadric.addPlane(normal / area, -dot(normal / area, a), 0.5 * area);
+
+            for(int j = 0 ; j < 3 ; ++j) {
+                quadrics[indices[i + j]].add(quadric);
+            }
+        }
+    }
+
+    /**** Collapses ****/
+    std::vector<unsigned int> result(indices.begin(), indices.end());
+    std::vector<Collapse> collapses;
+    std::vector<unsigned int> offsets;
+    std::vector<unsigned int> adjacency;
+    std::vector<bool> touched;
+    double largestCost = 0.0;
+    const double maxCost = static_cast<double>(maxError) * maxError;
+
+    // Each pass collapses independent edges, then removes the degenerate triangles
+    while(result.size() / 3 > targetTriangles) {
+        collapses.clear();
+        for(unsigned int i = 0 ; i < result.size() ; i += 3) {
+            for(int j = 0 ; j < 3 ; ++j) {
+                const unsigned int a = result[i + j];
+                const unsigned int b = result[i + (j + 1) % 3];
+
+                for(const auto& [from, to]: {std::pair(a, b), std::pair(b, a)}) {
+                    if(!locked[from]) {
+                        Quadric quadric = quadrics[from];
+                        quadric.add(quadrics[to]);
+                        collapses.push_back(Collapse{from, to, std::max(quadric.evaluate(positions[to]), 0.0)});
+                    }
+                }
+            }
+        }
+
+        std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b) {
+            return a.cost < b.cost;
+        });
+
+        // Triangles using each vertex, stored contiguously
+        offsets.assign(vertexCount + 1, 0);
+        for(unsigned int index: result) {
+            ++offsets[index + 1];
+        }
+        std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+        adjacency.resize(result.size());
+        std::vector<unsigned int> fill(offsets.begin(), offsets.end() - 1);
+        for(unsigned int i = 0 ; i < result.size() ; ++i) {
+            adjacency[fill[result[i]]++] = i / 3;
+        }
+
+        // Moving a vertex must not flip any of the triangles that remain around it
+        auto flips = [&](unsigned int from, unsigned int to) {
+            for(unsigned int i = offsets[from] ; i < offsets[from + 1] ; ++i) {
+                const unsigned int* triangle = &result[3 * adjacency[i]];
+                if(triangle[0] == to || triangle[1] == to || triangle[2] == to) {
+                    continue;
+                }
+
+                dvec3 before[3];
+                dvec3 after[3];
+                for(int j = 0 ; j < 3 ; ++j) {
+                    before[j] = positions[triangle[j]];
+                    after[j] = triangle[j] == from ? positions[to] : before[j];
+                }
+
+                const dvec3 normalBefore = cross(before[1] - before[0], before[2] - before[0]);
+                const dvec3 normalAfter = cross(after[1] - after[0], after[2] - after[0]);
+
+                if(dot(normalBefore, normalAfter) < 0.25 * length(normalBefore) * length(normalAfter)) {
+                    return true;
+                }
+            }
+
+            return false;
+        };
+
+        std::vector<unsigned int> remap(vertexCount);
+        std::iota(remap.begin(), remap.end(), 0u);
+        touched.assign(vertexCount, false);
+
+        const unsigned int budget = result.size() / 3 - targetTriangles;
+        unsigned int removed = 0;
+
+        for(const Collapse& collapse: collapses) {
+            if(collapse.cost > maxCost || removed >= budget) {
+                break;
+            }
+
+            if(touched[collapse.from] || touched[collapse.to] || flips(collapse.from, collapse.to)) {
+                continue;
+            }
+
+            remap[collapse.from] = collapse.to;
+            quadrics[collapse.to].add(quadrics[collapse.from]);
+            largestCost = std::max(largestCost, collapse.cost);
+
+            // The whole neighbourhood is frozen so that the flip tests of this pass stay valid
+            for(unsigned int i = offsets[collapse.from] ; i < offsets[collapse.from + 1] ; ++i) {
+                const unsigned int* triangle = &result[3 * adjacency[i]];
+                removed += triangle[0] == collapse.to || triangle[1] == collapse.to || triangle[2] == collapse.to;
+
+                for(int j = 0 ; j < 3 ; ++j) {
+                    touched[triangle[j]] = true;
+                }
+            }
+        }
+
+        if(removed == 0) {
+            break;
+        }
+
+        unsigned int size = 0;
+        for(unsigned int i = 0 ; i < result.size() ; i += 3) {
+            const unsigned int a = remap[result[i]];
+            const unsigned int b = remap[result[i + 1]];
+            const unsigned int c = remap[result[i + 2]];
+
+            if(a != b && b != c && c != a) {
+                result[size++] = a;
+                result[size++] = b;
+                result[size++] = c;
+            }
+        }
+        result.resize(size);
+    }
+
+    if(error) {
+        *error = static_cast<float>(std::sqrt(largestCost));
+    }
+
+    return result;
+}
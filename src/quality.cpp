@@ -0,0 +1,19 @@
+/***************************************************************************************************
+ * @file  quality.cpp
+ * @brief Implementation of the quality tiers of the shaders
+ **************************************************************************************************/
+
+#include "quality.hpp"
+
+Shader::Defines Quality::getDefines(Tier tier) {
+    const Settings& settings = TIERS[tier];
+
+    return {
+        {"MAX_TESS_LEVEL", std::to_string(settings.tessLevel)},
+        {"CLOUD_STEPS", std::to_string(settings.cloudSteps)},
+        {"CLOUD_OCTAVES", std::to_string(settings.cloudOctaves)},
+        {"VORONOI_RANGE", std::to_string(settings.voronoiRange)},
+        {"MAX_STEPS", std::to_string(settings.waterSteps) + 'u'},
+        {"WAVE_OCTAVES", std::to_string(settings.waveOctaves)}
+    };
+}
@@ -0,0 +1,138 @@
+/***************************************************************************************************
+ * @file  TerrainCapture.cpp
+ * @brief Implementation of the TerrainCapture class
+ **************************************************************************************************/
+
+#include "terrain/TerrainCapture.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <glad/glad.h>
+
+#include "terrain/height.hpp"
+
+TerrainCapture::TerrainCapture(unsigned int maxTriangles)
+    : capacity(maxTriangles), fence(nullptr),
+      truncated(false), gpuTime(0.0f), readbackTime(0.0f), heightError(0.0f) {
+
+    glBindBuffer(GL_TRANSFORM_FEEDBACK_BUFFER, buffer);
+    glBufferData(GL_TRANSFORM_FEEDBACK_BUFFER, capacity * 3 * VERTEX_STRIDE * sizeof(float), nullptr, GL_STREAM_READ);
+    glBindBuffer(GL_TRANSFORM_FEEDBACK_BUFFER, 0);
+
+    glGenQueries(3, queries);
+}
+
+TerrainCapture::~TerrainCapture() {
+    if(fence) {
+        glDeleteSync(static_cast<GLsync>(fence));
+    }
+
+    glDeleteQueries(3, queries);
+}
+
+bool TerrainCapture::begin() {
+    if(fence) {
+        return false;
+    }
+
+    glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, buffer);
+    glEnable(GL_RASTERIZER_DISCARD);
+
+    glBeginQuery(GL_PRIMITIVES_GENERATED, queries[0]);
+    glBeginQuery(GL_TRANSFORM_FEEDBACK_PRIMITIVES_WRITTEN, queries[1]);
+    glBeginQuery(GL_TIME_ELAPSED, queries[2]);
+    glBeginTransformFeedback(GL_TRIANGLES);
+
+    return true;
+}
+
+void TerrainCapture::end() {
+    glEndTransformFeedback();
+    glEndQuery(GL_TIME_ELAPSED);
+    glEndQuery(GL_TRANSFORM_FEEDBACK_PRIMITIVES_WRITTEN);
+    glEndQuery(GL_PRIMITIVES_GENERATED);
+
+    glDisable(GL_RASTERIZER_DISCARD);
+    glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0);
+
+    fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+bool TerrainCapture::poll() {
+    if(!fence) {
+        return false;
+    }
+
+    // Flushes so that the fence is eventually signaled even if nothing else is submitted
+    if(glClientWaitSync(static_cast<GLsync>(fence), GL_SYNC_FLUSH_COMMANDS_BIT, 0) == GL_TIMEOUT_EXPIRED) {
+        return false;
+    }
+
+    glDeleteSync(static_cast<GLsync>(fence));
+    fence = nullptr;
+
+    const auto start = std::chrono::steady_clock::now();
+
+    unsigned int generated, written;
+    GLuint64 elapsed;
+    glGetQueryObjectuiv(queries[0], GL_QUERY_RESULT, &generated);
+    glGetQueryObjectuiv(queries[1], GL_QUERY_RESULT, &written);
+    glGetQueryObjectui64v(queries[2], GL_QUERY_RESULT, &elapsed);
+
+    truncated = generated > written;
+    gpuTime = elapsed / 1e6f;
+
+    vertices.resize(written * 3 * VERTEX_STRIDE);
+    glBindBuffer(GL_TRANSFORM_FEEDBACK_BUFFER, buffer);
+    glGetBufferSubData(GL_TRANSFORM_FEEDBACK_BUFFER, 0, vertices.size() * sizeof(float), vertices.data());
+    glBindBuffer(GL_TRANSFORM_FEEDBACK_BUFFER, 0);
+
+    readbackTime = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    heightError = vec2(0.0f);
+    for(unsigned int i = 0 ; i < vertices.size() ; i += VERTEX_STRIDE) {
+        const float error = std::abs(vertices[i + 1] - Terrain::getHeight(vec2(vertices[i], vertices[i + 2])));
+
+        heightError.x += error;
+        heightError.y = std::max(heightError.y, error);
+    }
+
+    if(!vertices.empty()) {
+        heightError.x /= vertices.size() / VERTEX_STRIDE;
+    }
+
+    return true;
+}
+
+bool TerrainCapture::isPending() const {
+    return fence != nullptr;
+}
+
+const std::vector<float>& TerrainCapture::getVertices() const {
+    return vertices;
+}
+
+Mesh TerrainCapture::toMesh() const {
+    return Mesh(GL_TRIANGLES, Mesh::NORMAL, std::vector<float>(vertices), {});
+}
+
+unsigned int TerrainCapture::getTriangleCount() const {
+    return vertices.size() / (3 * VERTEX_STRIDE);
+}
+
+bool TerrainCapture::isTruncated() const {
+    return truncated;
+}
+
+float TerrainCapture::getGPUTime() const {
+    return gpuTime;
+}
+
+float TerrainCapture::getReadbackTime() const {
+    return readbackTime;
+}
+
+vec2 TerrainCapture::getHeightError() const {
+    return heightError;
+}
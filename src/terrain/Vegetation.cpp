@@ -0,0 +1,466 @@
+/***************************************************************************************************
+ * @file  Vegetation.cpp
+ * @brief Implementation of the Vegetation class
+ **************************************************************************************************/
+
+#include "terrain/Vegetation.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <string>
+#include <utility>
+#include <glad/glad.h>
+
+#include "Frustum.hpp"
+#include "mesh/MeshCache.hpp"
+#include "mesh/meshes.hpp"
+#include "terrain/height.hpp"
+
+namespace {
+    constexpr unsigned int grassCandidates = 512; ///< Amount of grass placement attempts per tile.
+    constexpr unsigned int rockCandidates = 24;   ///< Amount of rock placement attempts per tile.
+    constexpr int samples = 8;                    ///< Side length of the grid used to sample slopes.
+    constexpr float waterLevel = 2.0f;            ///< Height under which nothing grows.
+    constexpr float margin = 3.0f;                ///< Extra height added to the tiles' bounds.
+    constexpr int rockDivTheta = 12;              ///< Horizontal divisions of the rock's sphere.
+    constexpr int rockDivPhi = 16;                ///< Vertical divisions of the rock's sphere.
+    constexpr float rockRatios[2]{0.4f, 0.15f};   ///< Triangle ratios of the rock's coarser LODs.
+    constexpr float rockMaxError = 0.25f;         ///< Largest error of the rock's LODs.
+    constexpr bool rockQuantized = true;          ///< Whether the rock's attributes are quantized.
+    constexpr float lodTolerance = 0.001f;        ///< Largest LOD error allowed per unit of distance.
+
+    /**
+     * @brief Builds the key of the rock in the mesh cache from the parameters of generateRock, so
+     * that changing any of them generates the rock again.
+     * @return The rock's key.
+     */
+    std::string getRockKey() {
+        std::string key = "rock_sphere_" + std::to_string(rockDivTheta) + '_' + std::to_string(rockDivPhi) + "_lods";
+        for(float ratio: rockRatios) {
+            key += '_' + std::to_string(ratio);
+        }
+
+        return key + '_' + std::to_string(rockMaxError) + (rockQuantized ? "_q" : "");
+    }
+
+    float smoothstep(float edge0, float edge1, float x) {
+        float t = std::clamp((x - edge0) / (edge1 - edge0), 0.0f, 1.0f);
+        return t * t * (3.0f - 2.0f * t);
+    }
+}
+
+Vegetation::Vegetation(float tileSize, int radius)
+    : tileSize(tileSize), radius(radius),
+      grassDistance(12.0f * tileSize),
+      grass(Meshes::grassTuft()),
+      rockACMR(0.0f), lodThroughput(0.0f), rockCached(false),
+      rock([this] {
+          const unsigned int hits = MeshCache::getHits();
+          Mesh mesh = MeshCache::get(getRockKey(), [this] { return generateRock(); });
+          rockCached = MeshCache::getHits() > hits;
+
+          return mesh;
+      }()),
+      uniformsShader(nullptr),
+      hasCameraTile(false),
+      stopping(false),
+      drawnInstances(0), storedInstances(0), cullingTime(0.0f) {
+
+    grass.setQuantized(true);
+
+    grass.setRetention(Mesh::RELEASE);
+    rock.setRetention(Mesh::RELEASE);
+
+    // hardware_concurrency returns 0 when unknown
+    const unsigned int threads = std::max(2u, std::thread::hardware_concurrency()) - 1u;
+    for(unsigned int i = 0 ; i < threads ; ++i) {
+        workers.emplace_back(&Vegetation::work, this);
+    }
+}
+
+Vegetation::~Vegetation() {
+    {
+        std::lock_guard lock(mutex);
+        stopping = true;
+    }
+
+    condition.notify_all();
+    for(std::thread& worker: workers) {
+        worker.join();
+    }
+}
+
+void Vegetation::update(const vec3& cameraPos) {
+    /**** Upload Finished Tiles ****/
+    std::vector<TileData> finished;
+    {
+        std::lock_guard lock(mutex);
+        finished.swap(results);
+    }
+
+    for(const TileData& data: finished) {
+        auto tile = tiles.find(key(data.coords.x, data.coords.y));
+
+        // The tile went out of range or was requested twice
+        if(tile == tiles.end() || tile->second.ready) {
+            continue;
+        }
+
+        tile->second = upload(data);
+        tile->second.origin = vec2(data.coords.x * tileSize, data.coords.y * tileSize);
+        storedInstances += tile->second.grassCount + tile->second.rockCount;
+    }
+
+    /**** Request & Delete Tiles ****/
+    const ivec2 tile(static_cast<int>(std::floor(cameraPos.x / tileSize)),
+                     static_cast<int>(std::floor(cameraPos.z / tileSize)));
+
+    if(hasCameraTile && tile.x == cameraTile.x && tile.y == cameraTile.y) {
+        return;
+    }
+
+    cameraTile = tile;
+    hasCameraTile = true;
+
+    auto inRange = [&](int x, int z) -> bool {
+        return std::abs(x - cameraTile.x) <= radius && std::abs(z - cameraTile.y) <= radius;
+    };
+
+    for(auto it = tiles.begin() ; it != tiles.end() ;) {
+        const int x = static_cast<int>(std::floor(it->second.origin.x / tileSize + 0.5f));
+        const int z = static_cast<int>(std::floor(it->second.origin.y / tileSize + 0.5f));
+
+        if(!inRange(x, z)) {
+            storedInstances -= it->second.grassCount + it->second.rockCount;
+            it = tiles.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    std::vector<ivec2> newRequests;
+    for(int z = cameraTile.y - radius ; z <= cameraTile.y + radius ; ++z) {
+        for(int x = cameraTile.x - radius ; x <= cameraTile.x + radius ; ++x) {
+            if(!tiles.contains(key(x, z))) {
+                Tile pending{};
+                pending.origin = vec2(x * tileSize, z * tileSize);
+                tiles.emplace(key(x, z), std::move(pending));
+                newRequests.emplace_back(x, z);
+            }
+        }
+    }
+
+    // Closest tiles are generated first
+    std::sort(newRequests.begin(), newRequests.end(), [&](const ivec2& a, const ivec2& b) {
+        return std::max(std::abs(a.x - cameraTile.x), std::abs(a.y - cameraTile.y))
+               < std::max(std::abs(b.x - cameraTile.x), std::abs(b.y - cameraTile.y));
+    });
+
+    {
+        std::lock_guard lock(mutex);
+
+        for(auto it = requests.begin() ; it != requests.end() ;) {
+            if(inRange(it->x, it->y)) {
+                ++it;
+            } else {
+                it = requests.erase(it);
+            }
+        }
+
+        requests.insert(requests.end(), newRequests.begin(), newRequests.end());
+    }
+
+    condition.notify_all();
+}
+
+void Vegetation::draw(Shader& shader, const mat4& vpMatrix, const vec3& cameraPos) {
+    /**** Culling ****/
+    const auto start = std::chrono::steady_clock::now();
+
+    const Frustum frustum(vpMatrix);
+
+    visibleTiles.clear();
+    for(const auto& [key, tile]: tiles) {
+        if(!tile.ready || tile.grassCount + tile.rockCount == 0) {
+            continue;
+        }
+
+        const vec3 low(tile.origin.x, tile.minY - margin, tile.origin.y);
+        const vec3 high(tile.origin.x + tileSize, tile.maxY + margin, tile.origin.y + tileSize);
+
+        if(!frustum.intersects(low, high)) {
+            continue;
+        }
+
+        // Grass gets sparser with distance, which works because the instances are in random order
+        const float dist = distance(vec2(cameraPos.x, cameraPos.z), tile.origin + vec2(0.5f * tileSize));
+        const float density = std::clamp(2.0f - 2.0f * dist / grassDistance, 0.0f, 1.0f);
+
+        visibleTiles.push_back(VisibleTile{
+            &tile,
+            static_cast<unsigned int>(density * tile.grassCount),
+            rock.selectLOD(dist, lodTolerance)
+        });
+    }
+
+    cullingTime = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    /**** Drawing ****/
+    if(&shader != uniformsShader) {
+        uniforms = {
+            .tileSize = shader.getUniformHandle<float>("tileSize"),
+            .tileOrigin = shader.getUniformHandle<vec2>("tileOrigin"),
+            .scaleRange = shader.getUniformHandle<vec2>("scaleRange"),
+            .stretch = shader.getUniformHandle<vec3>("stretch"),
+            .baseColor = shader.getUniformHandle<vec3>("baseColor")
+        };
+        uniformsShader = &shader;
+    }
+
+    drawnInstances = 0;
+    uniforms.tileSize.set(tileSize);
+
+    // Grass
+    uniforms.scaleRange.set(vec2(0.6f, 1.4f));
+    uniforms.stretch.set(vec3(1.0f, 1.0f, 1.0f));
+    uniforms.baseColor.set(vec3(0.32f, 0.45f, 0.16f));
+
+    for(const VisibleTile& visible: visibleTiles) {
+        if(visible.grassCount > 0) {
+            uniforms.tileOrigin.set(visible.tile->origin);
+            bindInstances(grass, *visible.tile, 0);
+            grass.drawInstanced(visible.grassCount);
+            drawnInstances += visible.grassCount;
+        }
+    }
+
+    // Rocks
+    uniforms.scaleRange.set(vec2(0.4f, 2.0f));
+    uniforms.stretch.set(vec3(1.0f, 0.6f, 1.0f));
+    uniforms.baseColor.set(vec3(0.45f, 0.43f, 0.40f));
+
+    for(const VisibleTile& visible: visibleTiles) {
+        if(visible.tile->rockCount > 0) {
+            uniforms.tileOrigin.set(visible.tile->origin);
+            bindInstances(rock, *visible.tile, 4);
+            rock.setLOD(visible.rockLOD);
+            rock.drawInstanced(visible.tile->rockCount);
+            drawnInstances += visible.tile->rockCount;
+        }
+    }
+}
+
+unsigned int Vegetation::getDrawnInstances() const {
+    return drawnInstances;
+}
+
+float Vegetation::getCullingTime() const {
+    return cullingTime;
+}
+
+unsigned int Vegetation::getTileCount() const {
+    return std::count_if(tiles.begin(), tiles.end(), [](const auto& tile) { return tile.second.ready; });
+}
+
+unsigned int Vegetation::getStoredInstances() const {
+    return storedInstances;
+}
+
+const std::vector<Mesh::LOD>& Vegetation::getRockLODs() const {
+    return rock.getLODs();
+}
+
+bool Vegetation::isRockCached() const {
+    return rockCached;
+}
+
+float Vegetation::getLODThroughput() const {
+    return lodThroughput;
+}
+
+vec2 Vegetation::getRockACMR() const {
+    return rockACMR;
+}
+
+unsigned int Vegetation::getMeshCPUSize() const {
+    return grass.getCPUSize() + rock.getCPUSize();
+}
+
+unsigned int Vegetation::getMeshGPUSize() const {
+    return grass.getGPUSize() + rock.getGPUSize();
+}
+
+Mesh Vegetation::generateRock() {
+    Mesh mesh = Meshes::sphere(rockDivTheta, rockDivPhi);
+
+    const auto start = std::chrono::steady_clock::now();
+    mesh.generateLODs(rockRatios, rockMaxError);
+    const float seconds = std::chrono::duration<float>(std::chrono::steady_clock::now() - start).count();
+
+    // Each level is simplified from the previous one
+    unsigned int simplified = 0;
+    for(unsigned int i = 0 ; i + 1 < mesh.getLODs().size() ; ++i) {
+        simplified += mesh.getLODs()[i].indexCount / 3;
+    }
+    lodThroughput = simplified / std::max(seconds, 1e-6f);
+
+    rockACMR.x = mesh.getACMR();
+    mesh.optimize();
+    rockACMR.y = mesh.getACMR();
+
+    mesh.setQuantized(rockQuantized);
+
+    return mesh;
+}
+
+void Vegetation::work() {
+    while(true) {
+        ivec2 coords;
+
+        {
+            std::unique_lock lock(mutex);
+            condition.wait(lock, [this] { return stopping || !requests.empty(); });
+
+            if(stopping) {
+                return;
+            }
+
+            coords = requests.front();
+            requests.pop_front();
+        }
+
+        TileData data = generate(coords);
+
+        {
+            std::lock_guard lock(mutex);
+            results.push_back(std::move(data));
+        }
+    }
+}
+
+Vegetation::TileData Vegetation::generate(const ivec2& coords) const {
+    TileData data;
+    data.coords = coords;
+    data.minY = Terrain::getMaxHeight();
+    data.maxY = Terrain::getMinHeight();
+
+    const vec2 origin(coords.x * tileSize, coords.y * tileSize);
+    const float spacing = tileSize / samples;
+
+    /**** Slope Grid ****/
+    float heights[samples + 1][samples + 1];
+    for(int z = 0 ; z <= samples ; ++z) {
+        for(int x = 0 ; x <= samples ; ++x) {
+            heights[z][x] = Terrain::getHeight(origin + vec2(x * spacing, z * spacing));
+        }
+    }
+
+    // Returns the approximate height and the y component of the normal at a point of the tile
+    auto sampleGrid = [&](float u, float v) -> vec2 {
+        const int x = std::min(static_cast<int>(u * samples), samples - 1);
+        const int z = std::min(static_cast<int>(v * samples), samples - 1);
+        const float fx = u * samples - x;
+        const float fz = v * samples - z;
+
+        const float h00 = heights[z][x], h10 = heights[z][x + 1];
+        const float h01 = heights[z + 1][x], h11 = heights[z + 1][x + 1];
+
+        const float dx = ((1.0f - fz) * (h10 - h00) + fz * (h11 - h01)) / spacing;
+        const float dz = ((1.0f - fx) * (h01 - h00) + fx * (h11 - h10)) / spacing;
+        const float height = (1.0f - fz) * ((1.0f - fx) * h00 + fx * h10) + fz * ((1.0f - fx) * h01 + fx * h11);
+
+        return vec2(height, 1.0f / std::sqrt(dx * dx + dz * dz + 1.0f));
+    };
+
+    /**** Placement ****/
+    std::minstd_rand random(static_cast<unsigned int>(static_cast<uint64_t>(key(coords.x, coords.y)) * 2654435761u));
+    std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+
+    auto place = [&](Instances& instances, unsigned int candidates, auto&& probability) {
+        for(unsigned int i = 0 ; i < candidates ; ++i) {
+            const float u = uniform(random);
+            const float v = uniform(random);
+            const float chance = uniform(random);
+            const float scale = uniform(random);
+
+            const vec2 sample = sampleGrid(u, v);
+            if(sample.x < waterLevel || chance >= probability(Terrain::getSplatWeights(sample.x), sample.y)) {
+                continue;
+            }
+
+            const float height = Terrain::getHeight(origin + vec2(u, v) * tileSize);
+            data.minY = std::min(data.minY, height);
+            data.maxY = std::max(data.maxY, height);
+
+            instances.x.push_back(static_cast<uint16_t>(u * 65535.0f));
+            instances.z.push_back(static_cast<uint16_t>(v * 65535.0f));
+            instances.y.push_back(height);
+            instances.scale.push_back(static_cast<uint8_t>(scale * 255.0f));
+        }
+    };
+
+    // Grass grows on flat grassy ground
+    place(data.grass, grassCandidates, [](const vec4& weights, float normalY) -> float {
+        return (weights.x + weights.y) * smoothstep(0.8f, 0.95f, normalY);
+    });
+
+    // Rocks lie on rocky ground and on steep slopes
+    place(data.rocks, rockCandidates, [](const vec4& weights, float normalY) -> float {
+        return 0.5f * std::min(1.0f, weights.z + 1.0f - smoothstep(0.6f, 0.9f, normalY));
+    });
+
+    return data;
+}
+
+Vegetation::Tile Vegetation::upload(const TileData& data) {
+    Tile tile{};
+    tile.ready = true;
+    tile.grassCount = data.grass.y.size();
+    tile.rockCount = data.rocks.y.size();
+    tile.minY = data.minY;
+    tile.maxY = data.maxY;
+
+    if(tile.grassCount + tile.rockCount == 0) {
+        return tile;
+    }
+
+    /**** Structure of Arrays ****/
+    std::vector<unsigned char> blob;
+    unsigned int array = 0;
+
+    auto append = [&](const auto& values) {
+        const auto* bytes = reinterpret_cast<const unsigned char*>(values.data());
+
+        tile.offsets[array++] = blob.size();
+        blob.insert(blob.end(), bytes, bytes + values.size() * sizeof(values[0]));
+        blob.resize((blob.size() + 3) & ~3u); // Keeps every array 4-byte aligned
+    };
+
+    for(const Instances* instances: {&data.grass, &data.rocks}) {
+        append(instances->x);
+        append(instances->z);
+        append(instances->y);
+        append(instances->scale);
+    }
+
+    tile.buffer.emplace();
+    glBindBuffer(GL_ARRAY_BUFFER, *tile.buffer);
+    glBufferData(GL_ARRAY_BUFFER, blob.size(), blob.data(), GL_STATIC_DRAW);
+
+    return tile;
+}
+
+void Vegetation::bindInstances(Mesh& mesh, const Tile& tile, unsigned int first) {
+    constexpr unsigned int location = Mesh::FIRST_INSTANCE_LOCATION;
+
+    mesh.setInstanceAttribute(location, *tile.buffer, 1, GL_UNSIGNED_SHORT, true, tile.offsets[first]);
+    mesh.setInstanceAttribute(location + 1, *tile.buffer, 1, GL_UNSIGNED_SHORT, true, tile.offsets[first + 1]);
+    mesh.setInstanceAttribute(location + 2, *tile.buffer, 1, GL_FLOAT, false, tile.offsets[first + 2]);
+    mesh.setInstanceAttribute(location + 3, *tile.buffer, 1, GL_UNSIGNED_BYTE, true, tile.offsets[first + 3]);
+}
+
+int64_t Vegetation::key(int x, int z) {
+    return (static_cast<int64_t>(x) << 32) | static_cast<uint32_t>(z);
+}
@@ -0,0 +1,138 @@
+/***************************************************************************************************
+ * @file  height.cpp
+ * @brief Implementation of functions to sample the terrain's height on the CPU
+ **************************************************************************************************/
+
+#include "terrain/height.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <glm/geometric.hpp>
+
+namespace {
+    /**
+     * @struct Noise
+     * @brief Parameters of one of the noises making up the terrain.
+     */
+    struct Noise {
+        float frequency; ///< The frequency of the first octave.
+        float amplitude; ///< The amplitude of the first octave.
+        float height;    ///< The base height of the noise.
+    };
+
+    constexpr Noise plains{0.01f, 25.0f, -37.0f};
+    constexpr Noise plateaux{0.003f, 130.0f, 0.0f};
+    constexpr Noise mountains{0.004f, 250.0f, 25.0f};
+
+    constexpr unsigned int octaves = 8;
+
+    float fract(float x) {
+        return x - std::floor(x);
+    }
+
+    float fade(float x) {
+        float x3 = x * x * x;
+        return 6.0f * x3 * x * x - 15.0f * x3 * x + 10.0f * x3;
+    }
+
+    float smoothLerp(float a, float b, float t) {
+        return a + fade(t) * (b - a);
+    }
+
+    float rand2D(float x, float y) {
+        return fract(std::sin(x * 12.9898f + y * 78.233f) * 43758.5453f);
+    }
+
+    float perlinNoise(float x, float y) {
+        const float floorX = std::floor(x);
+        const float floorY = std::floor(y);
+        const float fractX = x - floorX;
+        const float fractY = y - floorY;
+
+        float g00 = rand2D(floorX, floorY);
+        float g01 = rand2D(floorX, floorY + 1.0f);
+        float g10 = rand2D(floorX + 1.0f, floorY);
+        float g11 = rand2D(floorX + 1.0f, floorY + 1.0f);
+
+        float nx = smoothLerp(g00, g10, fractX);
+        float ny = smoothLerp(g01, g11, fractX);
+
+        return smoothLerp(nx, ny, fractY);
+    }
+
+    float getNoise(const vec2& position, const Noise& noise) {
+        return (perlinNoise(position.x * noise.frequency, position.y * noise.frequency) - 0.5f) * noise.amplitude;
+    }
+
+    constexpr float getExtremeHeight(const Noise& noise, float sign) {
+        float height = noise.height;
+        float amplitude = noise.amplitude;
+
+        for(unsigned int i = 0 ; i < octaves ; ++i) {
+            amplitude /= 2.0f;
+            height += sign * amplitude;
+        }
+
+        return height;
+    }
+
+    constexpr float minHeight = getExtremeHeight(plains, -1.0f);
+    constexpr float maxHeight = getExtremeHeight(mountains, 1.0f);
+}
+
+float Terrain::getHeight(const vec2& position) {
+    Noise noises[3]{plains, plateaux, mountains};
+    float heights[3]{plains.height, plateaux.height, mountains.height};
+
+    for(unsigned int i = 0 ; i < octaves ; ++i) {
+        for(int j = 0 ; j < 3 ; ++j) {
+            heights[j] += getNoise(position, noises[j]);
+            noises[j].frequency *= 2.0f;
+            noises[j].amplitude /= 2.0f;
+        }
+    }
+
+    return std::max(std::max(heights[0], heights[1]), heights[2]);
+}
+
+vec3 Terrain::getNormal(const vec2& position, float epsilon) {
+    const vec3 p(position.x, getHeight(position), position.y);
+    const vec3 pX(position.x + epsilon, getHeight(vec2(position.x + epsilon, position.y)), position.y);
+    const vec3 pZ(position.x, getHeight(vec2(position.x, position.y + epsilon)), position.y + epsilon);
+
+    return normalize(cross(pZ - p, pX - p));
+}
+
+float Terrain::getMinHeight() {
+    return minHeight;
+}
+
+float Terrain::getMaxHeight() {
+    return maxHeight;
+}
+
+vec4 Terrain::getSplatWeights(float height) {
+    /* x: Low Height ; y: Optimal Height ; z: High Height */
+    constexpr float heights[4][3]{
+        {0.000f, 0.100f, 0.200f},
+        {0.110f, 0.220f, 0.450f},
+        {0.240f, 0.475f, 0.700f},
+        {0.500f, 0.720f, 1.000f}
+    };
+
+    height = (height - minHeight) / (maxHeight - minHeight);
+
+    vec4 weights;
+    for(int i = 0 ; i < 4 ; ++i) {
+        float t;
+        if(height < heights[i][1]) {
+            t = (height - heights[i][0]) / (heights[i][1] - heights[i][0]);
+        } else {
+            t = (heights[i][2] - height) / (heights[i][2] - heights[i][1]);
+        }
+
+        weights[i] = std::clamp(t, 0.0f, 1.0f);
+    }
+
+    return weights;
+}
@@ -0,0 +1,114 @@
+/***************************************************************************************************
+ * @file  mesh_moves.cpp
+ * @brief Checks that meshes are moved without copying their data or creating GL objects
+ **************************************************************************************************/
+
+#include <iostream>
+#include <utility>
+#include <vector>
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include "mesh/Mesh.hpp"
+#include "mesh/meshes.hpp"
+
+namespace {
+    constexpr int skipped = 77; ///< Exit code telling CTest the test was skipped.
+
+    /**
+     * @struct Counts
+     * @brief Snapshot of the copy and creation counters.
+     */
+    struct Counts {
+        Counts()
+            : copies(Mesh::getCopyCount()),
+              vertexArrays(VertexArray::getCreatedCount()),
+              buffers(Buffer::getCreatedCount()) { }
+
+        bool operator== (const Counts&) const = default;
+
+        unsigned int copies;
+        unsigned int vertexArrays;
+        unsigned int buffers;
+    };
+
+    int failures = 0;
+
+    void check(bool condition, const char* message) {
+        if(!condition) {
+            std::cerr << "FAILED: " << message << '\n';
+            ++failures;
+        }
+    }
+}
+
+int main() {
+    // A hidden window is enough to get a context, no display output is needed
+    if(!glfwInit()) {
+        std::cerr << "No display available, skipping.\n";
+        return skipped;
+    }
+
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 2);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+    GLFWwindow* window = glfwCreateWindow(1, 1, "Mesh moves", nullptr, nullptr);
+    if(!window) {
+        std::cerr << "Failed to create an OpenGL 4.2 context, skipping.\n";
+        glfwTerminate();
+        return skipped;
+    }
+
+    glfwMakeContextCurrent(window);
+    if(!gladLoadGLLoader((GLADloadproc) glfwGetProcAddress)) {
+        std::cerr << "Failed to load OpenGL functions.\n";
+        return 1;
+    }
+
+    {
+        Mesh cube = Meshes::cube();
+        Mesh grid = Meshes::tessGrid(1.0f, 4);
+
+        /**** Move construction ****/
+        Counts before;
+        Mesh moved = std::move(cube);
+        check(Counts() == before, "Move construction copied or created GL objects.");
+        check(moved.getData()->size() > 0, "Move construction lost the data.");
+
+        /**** Move assignment ****/
+        Mesh target(GL_TRIANGLES);
+        before = Counts();
+        target = std::move(grid);
+        check(Counts() == before, "Move assignment copied or created GL objects.");
+        check(target.getPrimitive() == GL_PATCHES, "Move assignment lost the primitive.");
+
+        /**** Reallocation ****/
+        std::vector<Mesh> meshes;
+        for(int i = 0 ; i < 16 ; ++i) {
+            meshes.push_back(Meshes::screen());
+        }
+        meshes.push_back(std::move(moved));
+
+        before = Counts();
+        meshes.reserve(2 * meshes.capacity());
+        check(Counts() == before, "Growing a vector of meshes copied them.");
+
+        /**** Copies are counted ****/
+        before = Counts();
+        const Mesh copy(target);
+        const Counts after;
+        check(after.copies == before.copies + 1, "A copy was not counted.");
+        check(after.vertexArrays == before.vertexArrays + 1, "A copy didn't create its own VAO.");
+    }
+
+    glfwDestroyWindow(window);
+    glfwTerminate();
+
+    if(failures == 0) {
+        std::cout << "All mesh move checks passed.\n";
+    }
+
+    return failures == 0 ? 0 : 1;
+}